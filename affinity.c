@@ -0,0 +1,143 @@
+#define _GNU_SOURCE
+#include "philo.h"
+#include <sched.h>
+
+/*
+ * --affinity, the TOPOLOGY
+ * Every cpu we are allowed to run on (sched_getaffinity,
+ * so taskset and cgroups are respected) gets from sysfs:
+ * 	~node:	/sys/devices/system/cpu/cpuN/nodeM
+ * 	~llc:	id of the last level cache (index3, else index2)
+ * 	~core:	topology/core_id
+ * Sorted by node, llc, core: a contiguous block of the array
+ * shares a cache, so contiguous philos share their forks
+ * inside that cache (affinity_place.c).
+ *
+ * 💡 No sysfs (old kernel, odd container): every cpu is
+ * 	node 0, llc 0, the placement is still a plain block split 💡
+*/
+
+static long	read_sysfs(const char *fmt, long cpu, long fallback)
+{
+	char	path[128];
+	FILE	*file;
+	long	value;
+
+	snprintf(path, sizeof(path), fmt, cpu);
+	file = fopen(path, "r");
+	if (NULL == file)
+		return (fallback);
+	if (1 != fscanf(file, "%ld", &value))
+		value = fallback;
+	fclose(file);
+	return (value);
+}
+
+static long	cpu_node(long cpu)
+{
+	char	path[128];
+	long	node;
+
+	node = -1;
+	while (++node < AFFINITY_NODE_MAX)
+	{
+		snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%ld/node%ld",
+			cpu, node);
+		if (0 == access(path, F_OK))
+			return (node);
+	}
+	return (0);
+}
+
+static bool	cpu_before(t_cpu *a, t_cpu *b)
+{
+	if (a->node != b->node)
+		return (a->node < b->node);
+	if (a->llc != b->llc)
+		return (a->llc < b->llc);
+	if (a->core != b->core)
+		return (a->core < b->core);
+	return (a->cpu < b->cpu);
+}
+
+/*
+ * Insertion sort, a few hundred cpus at most
+*/
+static void	sort_cpus(t_affinity *aff)
+{
+	long	i;
+	long	j;
+	t_cpu	key;
+
+	i = 0;
+	while (++i < aff->cpu_nbr)
+	{
+		key = aff->cpus[i];
+		j = i - 1;
+		while (j >= 0 && cpu_before(&key, aff->cpus + j))
+		{
+			aff->cpus[j + 1] = aff->cpus[j];
+			--j;
+		}
+		aff->cpus[j + 1] = key;
+	}
+}
+
+/*
+ * Read the topology, count the nodes and keep the
+ * last cpus for the monitors, if there are enough cpus
+ * to leave at least one to the philos
+*/
+void	affinity_init(t_table *table)
+{
+	t_affinity	*aff;
+	cpu_set_t	set;
+	long		cpu;
+
+	aff = &table->aff;
+	memset(aff, 0, sizeof(t_affinity));
+	if (!table->opt.affinity || ENGINE_VIRTUAL == table->opt.engine
+		|| sched_getaffinity(0, sizeof(set), &set))
+		return ;
+	aff->cpus = safe_malloc(CPU_COUNT(&set) * sizeof(t_cpu));
+	cpu = -1;
+	while (++cpu < CPU_SETSIZE)
+	{
+		if (!CPU_ISSET(cpu, &set))
+			continue ;
+		aff->cpus[aff->cpu_nbr].cpu = cpu;
+		aff->cpus[aff->cpu_nbr].node = cpu_node(cpu);
+		aff->cpus[aff->cpu_nbr].llc = read_sysfs("/sys/devices/system/cpu/"
+				"cpu%ld/cache/index3/id", cpu, read_sysfs("/sys/devices/"
+					"system/cpu/cpu%ld/cache/index2/id", cpu, 0));
+		aff->cpus[aff->cpu_nbr++].core = read_sysfs("/sys/devices/system/"
+				"cpu/cpu%ld/topology/core_id", cpu, cpu);
+	}
+	sort_cpus(aff);
+	aff->node_nbr = 1;
+	cpu = 0;
+	while (++cpu < aff->cpu_nbr)
+		if (aff->cpus[cpu].node != aff->cpus[cpu - 1].node)
+			++aff->node_nbr;
+	aff->philo_cpus = aff->cpu_nbr;
+	if (aff->cpu_nbr > table->monitor_nbr + 1)
+		aff->philo_cpus = aff->cpu_nbr - table->monitor_nbr;
+}
+
+/*
+ * METRICS=1, one line on stderr
+*/
+void	affinity_report(t_table *table)
+{
+	t_affinity	*aff;
+
+	aff = &table->aff;
+	if (NULL == aff->cpus)
+		return ;
+	fprintf(stderr, "[metrics] affinity: %ld cpus on %ld nodes, philos on "
+		"%ld", aff->cpu_nbr, aff->node_nbr, aff->philo_cpus);
+	if (aff->cpu_nbr == aff->philo_cpus)
+		fprintf(stderr, ", monitors share them\n");
+	else
+		fprintf(stderr, ", monitors on %ld\n", aff->cpu_nbr - aff->philo_cpus);
+}
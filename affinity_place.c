@@ -0,0 +1,147 @@
+#define _GNU_SOURCE
+#include "philo.h"
+#include <sched.h>
+#if NUMA
+# include <numa.h>
+#endif
+
+/*
+ * --affinity, the PLACEMENT
+ * 	~philo i (or worker i) -> block i * philo_cpus / count
+ * 		of the sorted cpus: neighbours, and the fork between
+ * 		them, stay on cpus sharing a cache
+ * 	~monitors -> the reserved cpus at the end, alone
+ * 	~philos, forks and deadlines of a node block are
+ * 		allocated on that node, before anybody writes them
+ *
+ * 💡 Single node: nothing to move, only the pinning.
+ * 	One cpu: everything on it, like without --affinity 💡
+*/
+
+/*
+ * Position in aff->cpus of the idx-th of count threads
+*/
+static long	slot(t_table *table, long idx, long count)
+{
+	return (idx * table->aff.philo_cpus / count);
+}
+
+/*
+ * The thread is parked at the start gate,
+ * a failure (cpu gone offline) just leaves it unpinned
+*/
+static void	pin(pthread_t thread, long cpu)
+{
+	cpu_set_t	set;
+
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	pthread_setaffinity_np(thread, sizeof(set), &set);
+}
+
+/*
+ * NUMA=1: libnuma binds the pages, nothing to touch
+*/
+#if NUMA
+
+static bool	numa_place(t_table *table, long node, long lo, long hi)
+{
+	if (numa_available() < 0)
+		return (false);
+	numa_tonode_memory(table->philos + lo, (hi - lo) * sizeof(t_philo), node);
+	numa_tonode_memory(table->forks + lo, (hi - lo) * sizeof(t_fork), node);
+	numa_tonode_memory(table->deadlines + lo, (hi - lo) * sizeof(t_along),
+		node);
+	return (true);
+}
+#else
+
+static bool	numa_place(t_table *table, long node, long lo, long hi)
+{
+	(void)table;
+	(void)node;
+	(void)lo;
+	(void)hi;
+	return (false);
+}
+#endif
+
+/*
+ * Philos [lo, hi) run on node: their memory goes there.
+ * Without libnuma, first touch: main runs on the node
+ * cpus while it zeroes the still untouched pages
+*/
+static void	place(t_table *table, long node, long lo, long hi)
+{
+	cpu_set_t	set;
+	long		i;
+
+	if (numa_place(table, node, lo, hi))
+		return ;
+	CPU_ZERO(&set);
+	i = -1;
+	while (++i < table->aff.cpu_nbr)
+		if (table->aff.cpus[i].node == node)
+			CPU_SET(table->aff.cpus[i].cpu, &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+	memset(table->philos + lo, 0, (hi - lo) * sizeof(t_philo));
+	memset(table->forks + lo, 0, (hi - lo) * sizeof(t_fork));
+	memset(table->deadlines + lo, 0, (hi - lo) * sizeof(t_along));
+}
+
+/*
+ * Right after the allocation, before data_init writes a byte.
+ * THREAD engine only: the coroutines are spread round robin
+ * on the workers, no node owns a contiguous block of philos
+*/
+void	affinity_first_touch(t_table *table)
+{
+	cpu_set_t	saved;
+	long		lo;
+	long		hi;
+	long		node;
+
+	if (table->aff.node_nbr < 2 || ENGINE_THREAD != table->opt.engine
+		|| pthread_getaffinity_np(pthread_self(), sizeof(saved), &saved))
+		return ;
+	lo = 0;
+	while (lo < table->philo_nbr)
+	{
+		node = table->aff.cpus[slot(table, lo, table->philo_nbr)].node;
+		hi = lo;
+		while (hi < table->philo_nbr
+			&& table->aff.cpus[slot(table, hi, table->philo_nbr)].node == node)
+			++hi;
+		place(table, node, lo, hi);
+		lo = hi;
+	}
+	pthread_setaffinity_np(pthread_self(), sizeof(saved), &saved);
+}
+
+/*
+ * Main, before opening the gate: every thread is created
+ * and waiting, pin them all
+*/
+void	affinity_apply(t_table *table)
+{
+	t_affinity	*aff;
+	long		i;
+	long		reserved;
+
+	aff = &table->aff;
+	if (NULL == aff->cpus)
+		return ;
+	i = -1;
+	while (ENGINE_THREAD == table->opt.engine && ++i < table->philo_nbr)
+		pin(table->philos[i].thread_id,
+			aff->cpus[slot(table, i, table->philo_nbr)].cpu);
+	i = -1;
+	while (ENGINE_CORO == table->opt.engine && ++i < table->opt.workers)
+		pin(table->sched.workers[i].thread,
+			aff->cpus[slot(table, i, table->opt.workers)].cpu);
+	reserved = aff->cpu_nbr - aff->philo_cpus;
+	i = -1;
+	while (reserved && ++i < table->monitor_nbr)
+		pin(table->monitors[i].thread,
+			aff->cpus[aff->philo_cpus + i % reserved].cpu);
+}
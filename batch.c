@@ -0,0 +1,150 @@
+#include "philo.h"
+
+/*
+ * BATCH RUNNER, --batch=file
+ * Sweeping configs used to mean thousands of ./philo:
+ * argv, mallocs, threads, exit, again and again.
+ * Here ONE process runs every line of the file:
+ *
+ * 	~--jobs=N worker threads, each one takes the next
+ * 		scenario (fetch_add) and runs a whole table in it:
+ * 		parse_input, data_init, dinner_start, clean
+ * 	~the tables share nothing but the options and the
+ * 		spin window, calibrated once
+ * 	~the classic log of a table goes nowhere, one result
+ * 		line per scenario on stdout instead, in the order
+ * 		they end, then the survive / die summary
+ *
+ * 💡 A refused scenario is a result, not an exit:
+ * 	parse_input fills table->error and the others go on 💡
+ *
+ * ./philo --virtual-time --jobs=4 --batch=sweep.txt
+*/
+
+static void	run_scenario(t_batch *batch, t_scenario *sc)
+{
+	t_table	table;
+	long	start;
+
+	start = gettime(NANOSECOND);
+	table.opt = batch->opt;
+	table.spin_ns = batch->spin_ns;
+	table.pool = NULL;
+	if (!parse_input(&table, sc->av))
+	{
+		sc->res.outcome = OUTCOME_ERROR;
+		memcpy(sc->error, table.error, ERROR_MAX);
+		return ;
+	}
+	data_init(&table);
+	dinner_start(&table);
+	table_outcome(&table, &sc->res);
+	clean(&table);
+	sc->res.wall = gettime(NANOSECOND) - start;
+}
+
+/*
+ * #line  the values  the result  (real time)
+*/
+static void	report(t_batch *batch, t_scenario *sc)
+{
+	t_result	*res;
+	long		i;
+
+	res = &sc->res;
+	safe_mutex_handle(&batch->print_mutex, LOCK);
+	printf(W"#%-5ld"RST, sc->line);
+	i = 0;
+	while (++i <= 5 && sc->av[i])
+		printf(" %s", sc->av[i]);
+	if (OUTCOME_ERROR == res->outcome)
+		printf(RED"\terror: %s\n"RST, sc->error);
+	else if (OUTCOME_DIED == res->outcome)
+		printf(RED"\t%ld died at %ld ms"RST, res->dead_id, res->died_ms);
+	else if (OUTCOME_FULL == res->outcome)
+		printf(G"\tall full"RST);
+	else
+		printf(G"\tsurvived %ld ms"RST,
+			batch->opt.duration / NSEC_PER_MSEC);
+	if (OUTCOME_ERROR != res->outcome)
+		printf(", meals %ld..%ld (%ld ms)\n", res->meals_min,
+			res->meals_max, res->wall / NSEC_PER_MSEC);
+	fflush(stdout);
+	safe_mutex_handle(&batch->print_mutex, UNLOCK);
+}
+
+static void	*batch_worker(void *data)
+{
+	t_batch	*batch;
+	long	i;
+
+	batch = (t_batch *)data;
+	i = atomic_fetch_add(&batch->next, 1);
+	while (i < batch->nbr)
+	{
+		if ('\0' == batch->scenarios[i].error[0])
+			run_scenario(batch, batch->scenarios + i);
+		report(batch, batch->scenarios + i);
+		i = atomic_fetch_add(&batch->next, 1);
+	}
+	return (NULL);
+}
+
+/*
+ * survived counts the full ones too
+*/
+static int	summary(t_batch *batch, long jobs, long wall)
+{
+	long	count[4];
+	long	i;
+
+	memset(count, 0, sizeof(count));
+	i = -1;
+	while (++i < batch->nbr)
+		count[batch->scenarios[i].res.outcome]++;
+	printf("[batch] %ld scenarios, %ld jobs, %.1f s: %ld survived "
+		"(%ld all full), %ld died, %ld errors\n", batch->nbr, jobs,
+		wall / 1e9, count[OUTCOME_SURVIVED] + count[OUTCOME_FULL],
+		count[OUTCOME_FULL], count[OUTCOME_DIED], count[OUTCOME_ERROR]);
+	if (count[OUTCOME_ERROR])
+		return (EXIT_FAILURE);
+	return (EXIT_SUCCESS);
+}
+
+/*
+ * calibrate_spin wants a table, a scratch one
+ * just for its spin_ns
+*/
+int	batch_run(t_options *opt)
+{
+	t_batch	batch;
+	t_table	probe;
+	long	jobs;
+	long	start;
+	long	i;
+
+	start = gettime(NANOSECOND);
+	batch.opt = *opt;
+	batch_load(&batch);
+	probe.opt = *opt;
+	calibrate_spin(&probe);
+	batch.spin_ns = probe.spin_ns;
+	atomic_init(&batch.next, 0);
+	safe_mutex_handle(&batch.print_mutex, INIT);
+	jobs = opt->jobs;
+	if (jobs > batch.nbr)
+		jobs = batch.nbr;
+	batch.workers = safe_malloc((jobs + 1) * sizeof(pthread_t));
+	i = -1;
+	while (++i < jobs)
+		safe_thread_handle(batch.workers + i, batch_worker, &batch, CREATE);
+	i = -1;
+	while (++i < jobs)
+		safe_thread_handle(batch.workers + i, NULL, NULL, JOIN);
+	i = summary(&batch, jobs, gettime(NANOSECOND) - start);
+	safe_mutex_handle(&batch.print_mutex, DESTROY);
+	free(batch.workers);
+	free(batch.scenarios);
+	free(batch.text);
+	return (i);
+}
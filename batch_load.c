@@ -0,0 +1,132 @@
+#include "philo.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+
+/*
+ * BATCH FILE, --batch=file
+ * One scenario per line, the classic arguments:
+ *
+ * 	# philo_nbr t_die t_eat t_sleep [meals]
+ * 	5 800 200 200 7
+ * 	4 310 200 100
+ *
+ * '#' starts a comment, blank lines are skipped.
+ * The values are checked later by parse_input, like argv:
+ * here only the count, 4 or 5
+*/
+
+/*
+ * The whole file in one buffer,
+ * the scenarios point inside it
+*/
+static char	*read_all(const char *path)
+{
+	struct stat	st;
+	char		*text;
+	long		len;
+	ssize_t		ret;
+	int			fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st))
+		error_exit("--batch: can't open the scenarios file");
+	text = safe_malloc(st.st_size + 1);
+	len = 0;
+	while (len < st.st_size)
+	{
+		ret = read(fd, text + len, st.st_size - len);
+		if (ret < 0 && EINTR == errno)
+			continue ;
+		if (ret <= 0)
+			break ;
+		len += ret;
+	}
+	close(fd);
+	text[len] = '\0';
+	return (text);
+}
+
+static bool	is_blank(char c)
+{
+	return (' ' == c || '\t' == c || '\r' == c);
+}
+
+/*
+ * Cut the line in place: av[1..5], NULL after the last one.
+ * Returns how many values, more than 5 is an error
+*/
+static long	split_line(char *line, char **av)
+{
+	long	n;
+
+	n = 0;
+	while (*line && '#' != *line)
+	{
+		if (is_blank(*line))
+			*line++ = '\0';
+		else
+		{
+			if (++n <= 5)
+				av[n] = line;
+			while (*line && '#' != *line && !is_blank(*line))
+				line++;
+		}
+	}
+	*line = '\0';
+	if (n <= 5)
+		av[n + 1] = NULL;
+	else
+		av[6] = NULL;
+	return (n);
+}
+
+/*
+ * 🚨 A line with the wrong count of values is not fatal:
+ * 	the scenario is kept with its error, reported in order
+ * 	with the others 🚨
+*/
+static void	add_line(t_batch *batch, char *line, long line_nbr)
+{
+	t_scenario	*sc;
+	long		n;
+
+	sc = batch->scenarios + batch->nbr;
+	memset(sc, 0, sizeof(t_scenario));
+	n = split_line(line, sc->av);
+	if (0 == n)
+		return ;
+	sc->line = line_nbr;
+	if (n < 4 || n > 5)
+	{
+		sc->res.outcome = OUTCOME_ERROR;
+		snprintf(sc->error, ERROR_MAX, "want philo_nbr t_die t_eat "
+			"t_sleep [meals], got %ld values", n);
+	}
+	batch->nbr++;
+}
+
+void	batch_load(t_batch *batch)
+{
+	char	*line;
+	char	*end;
+	long	lines;
+	long	line_nbr;
+
+	batch->text = read_all(batch->opt.batch);
+	lines = 1;
+	line = batch->text;
+	while (*line)
+		lines += ('\n' == *line++);
+	batch->scenarios = safe_malloc(lines * sizeof(t_scenario));
+	batch->nbr = 0;
+	line = batch->text;
+	line_nbr = 0;
+	while (line)
+	{
+		end = strchr(line, '\n');
+		if (end)
+			*end++ = '\0';
+		add_line(batch, line, ++line_nbr);
+		line = end;
+	}
+}
@@ -0,0 +1,437 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <signal.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+/*
+ * END TO END BENCHMARK, make bench
+ *
+ * Runs ./philo on a sweep of philo counts x timing tuples,
+ * reads its output through a pipe and writes one CSV row per run:
+ *
+ * 	~meals_per_sec:	"is eating" lines / simulated seconds
+ * 	~late_*:		eat start lateness, per philo, versus the ideal
+ * 				period max(t_eat + t_sleep, t_eat * n / (n / 2))
+ * 	~death_latency:	DIED timestamp - (last meal + t_die), -1 if alive
+ * 	~jain, meals_min, meals_max:	fairness of the meals per philo
+ * 	~margin:		t_die - longest gap between 2 meals (or
+ * 				the start) of any philo, <= 0 if one died
+ * 	~user/sys ms, max_rss_kb:	getrusage of the child (wait4)
+ *
+ * A run lasts until the dinner ends or --seconds, then SIGTERM.
+ * Timestamps in the log are ms, so is every measure here.
+ *
+ * ./bench [--out=file.csv] [--seconds=N] [--label=name]
+ * 		[--philo=./philo] [philo options...]
+ * Unknown --flags go to ./philo (i.e. --engine=coro), the label
+ * column keeps variants apart when you diff 2 CSV.
+*/
+
+#define MAX_FLAGS 16
+#define LINE_MAX_LEN 512
+#define DEFAULT_SECONDS 2
+
+typedef struct s_scenario
+{
+	long	die;
+	long	eat;
+	long	sleep;
+}			t_scenario;
+
+static const t_scenario	g_tuples[] = {
+{800, 200, 200},
+{410, 200, 200},
+{610, 200, 200},
+{310, 200, 100},
+};
+
+static const long		g_counts[] = {2, 3, 4, 5, 31, 64, 199, 200};
+static const long		g_beyond[] = {1000, 10000};
+
+typedef struct s_conf
+{
+	const char	*out;
+	const char	*label;
+	const char	*philo;
+	const char	*flags[MAX_FLAGS];
+	int			flags_nbr;
+	long		seconds;
+	bool		beyond;
+}			t_conf;
+
+/*
+ * What one run produced
+*/
+typedef struct s_run
+{
+	long			n;
+	t_scenario		s;
+	long			*last_eat;
+	long			*meals_per;
+	long			*late;
+	long			late_nbr;
+	long			late_cap;
+	long			meals;
+	long			last_ms;
+	long			death_latency;
+	long			max_gap;
+	struct rusage	ru;
+	char			line[LINE_MAX_LEN];
+	long			line_len;
+}			t_run;
+
+static long	now_ms(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000L + ts.tv_nsec / 1000000L);
+}
+
+static long	ideal_period(t_run *run)
+{
+	long	period;
+
+	period = run->s.eat + run->s.sleep;
+	if (run->n / 2 > 0 && run->s.eat * run->n / (run->n / 2) > period)
+		period = run->s.eat * run->n / (run->n / 2);
+	return (period);
+}
+
+static void	push_late(t_run *run, long late)
+{
+	if (run->late_nbr == run->late_cap)
+	{
+		run->late_cap = run->late_cap * 2 + 1024;
+		run->late = realloc(run->late, run->late_cap * sizeof(long));
+		if (!run->late)
+			exit(EXIT_FAILURE);
+	}
+	run->late[run->late_nbr++] = late;
+}
+
+/*
+ * Drop the ANSI colors, keep "ms id text"
+*/
+static void	strip_colors(char *line)
+{
+	char	*src;
+	char	*dst;
+
+	src = line;
+	dst = line;
+	while (*src)
+	{
+		if ('\033' == *src)
+		{
+			while (*src && 'm' != *src)
+				src++;
+			if (*src)
+				src++;
+			continue ;
+		}
+		*dst++ = *src++;
+	}
+	*dst = '\0';
+}
+
+/*
+ * Meal or death: how long since the last meal
+*/
+static void	gap(t_run *run, long ms, int id)
+{
+	long	since;
+
+	since = 0;
+	if (run->last_eat[id - 1] >= 0)
+		since = run->last_eat[id - 1];
+	if (ms - since > run->max_gap)
+		run->max_gap = ms - since;
+}
+
+static void	parse_line(t_run *run, char *line)
+{
+	long	ms;
+	int		id;
+
+	strip_colors(line);
+	if (2 != sscanf(line, "%ld %d", &ms, &id) || id < 1 || id > run->n)
+		return ;
+	run->last_ms = ms;
+	if (strstr(line, "died") || strstr(line, "is eating"))
+		gap(run, ms, id);
+	if (strstr(line, "died"))
+		run->death_latency = ms - run->s.die;
+	if (strstr(line, "died") && run->last_eat[id - 1] >= 0)
+		run->death_latency -= run->last_eat[id - 1];
+	if (!strstr(line, "is eating"))
+		return ;
+	run->meals++;
+	run->meals_per[id - 1]++;
+	if (run->last_eat[id - 1] >= 0)
+		push_late(run, ms - run->last_eat[id - 1] - ideal_period(run));
+	run->last_eat[id - 1] = ms;
+}
+
+/*
+ * Lines can be split between 2 reads
+*/
+static void	feed(t_run *run, char *buf, long len)
+{
+	long	i;
+
+	i = -1;
+	while (++i < len)
+	{
+		if ('\n' != buf[i] && run->line_len < LINE_MAX_LEN - 1)
+		{
+			run->line[run->line_len++] = buf[i];
+			continue ;
+		}
+		run->line[run->line_len] = '\0';
+		if ('\n' == buf[i])
+		{
+			parse_line(run, run->line);
+			run->line_len = 0;
+		}
+	}
+}
+
+/*
+ * Child: stdout in the pipe, stderr muted (metrics, summaries)
+*/
+static void	exec_philo(t_conf *conf, t_run *run, int fd)
+{
+	char	args[4][32];
+	char	*av[MAX_FLAGS + 7];
+	int		i;
+
+	dup2(fd, STDOUT_FILENO);
+	close(fd);
+	fd = open("/dev/null", O_WRONLY);
+	if (fd >= 0)
+		dup2(fd, STDERR_FILENO);
+	snprintf(args[0], 32, "%ld", run->n);
+	snprintf(args[1], 32, "%ld", run->s.die);
+	snprintf(args[2], 32, "%ld", run->s.eat);
+	snprintf(args[3], 32, "%ld", run->s.sleep);
+	av[0] = (char *)conf->philo;
+	i = -1;
+	while (++i < conf->flags_nbr)
+		av[i + 1] = (char *)conf->flags[i];
+	av[i + 1] = args[0];
+	av[i + 2] = args[1];
+	av[i + 3] = args[2];
+	av[i + 4] = args[3];
+	av[i + 5] = NULL;
+	execv(conf->philo, av);
+	perror(conf->philo);
+	exit(127);
+}
+
+/*
+ * Parent: read until EOF or the time is up,
+ * then collect the rusage of the child
+*/
+static void	collect(t_conf *conf, t_run *run, pid_t pid, int fd)
+{
+	struct pollfd	pfd;
+	char			buf[65536];
+	long			end;
+	ssize_t			len;
+	int				status;
+
+	end = now_ms() + conf->seconds * 1000;
+	pfd.fd = fd;
+	pfd.events = POLLIN;
+	while (now_ms() < end)
+	{
+		if (poll(&pfd, 1, end - now_ms()) <= 0)
+			continue ;
+		len = read(fd, buf, sizeof(buf));
+		if (len <= 0)
+			break ;
+		feed(run, buf, len);
+	}
+	kill(pid, SIGTERM);
+	while (read(fd, buf, sizeof(buf)) > 0)
+		;
+	close(fd);
+	wait4(pid, &status, 0, &run->ru);
+}
+
+static int	cmp_long(const void *a, const void *b)
+{
+	long	x;
+	long	y;
+
+	x = *(const long *)a;
+	y = *(const long *)b;
+	return ((x > y) - (x < y));
+}
+
+static long	percentile(t_run *run, long p)
+{
+	if (0 == run->late_nbr)
+		return (0);
+	return (run->late[(run->late_nbr - 1) * p / 100]);
+}
+
+/*
+ * Jain's index (Σx)² / (n·Σx²) of the meals, min and max
+*/
+static void	fairness_cols(FILE *csv, t_run *run)
+{
+	double	sum;
+	double	sum_sq;
+	long	min;
+	long	max;
+	long	i;
+
+	sum = 0;
+	sum_sq = 0;
+	min = run->meals_per[0];
+	max = run->meals_per[0];
+	i = -1;
+	while (++i < run->n)
+	{
+		sum += run->meals_per[i];
+		sum_sq += (double)run->meals_per[i] * run->meals_per[i];
+		if (run->meals_per[i] < min)
+			min = run->meals_per[i];
+		if (run->meals_per[i] > max)
+			max = run->meals_per[i];
+	}
+	if (0 == sum_sq)
+		sum_sq = 1;
+	fprintf(csv, ",%.4f,%ld,%ld", sum * sum / (run->n * sum_sq), min, max);
+}
+
+static void	csv_row(FILE *csv, t_conf *conf, t_run *run)
+{
+	double	meals_sec;
+
+	qsort(run->late, run->late_nbr, sizeof(long), cmp_long);
+	meals_sec = 0;
+	if (run->last_ms > 0)
+		meals_sec = run->meals * 1000.0 / run->last_ms;
+	fprintf(csv, "%s,%ld,%ld,%ld,%ld,%ld,%ld,%.1f,%ld,%ld,%ld,%ld,"
+		"%ld,%ld,%ld", conf->label, run->n, run->s.die, run->s.eat,
+		run->s.sleep, run->last_ms, run->meals, meals_sec,
+		percentile(run, 50), percentile(run, 99), percentile(run, 100),
+		run->death_latency,
+		run->ru.ru_utime.tv_sec * 1000L + run->ru.ru_utime.tv_usec / 1000,
+		run->ru.ru_stime.tv_sec * 1000L + run->ru.ru_stime.tv_usec / 1000,
+		run->ru.ru_maxrss);
+	fairness_cols(csv, run);
+	fprintf(csv, ",%ld\n", run->s.die - run->max_gap);
+	fflush(csv);
+}
+
+static void	run_one(FILE *csv, t_conf *conf, long n, const t_scenario *s)
+{
+	t_run	run;
+	int		fds[2];
+	pid_t	pid;
+	long	i;
+
+	memset(&run, 0, sizeof(run));
+	run.n = n;
+	run.s = *s;
+	run.death_latency = -1;
+	run.last_eat = malloc(n * sizeof(long));
+	run.meals_per = calloc(n, sizeof(long));
+	if (!run.last_eat || !run.meals_per || pipe(fds))
+		exit(EXIT_FAILURE);
+	i = -1;
+	while (++i < n)
+		run.last_eat[i] = -1;
+	pid = fork();
+	if (pid < 0)
+		exit(EXIT_FAILURE);
+	if (0 == pid)
+	{
+		close(fds[0]);
+		exec_philo(conf, &run, fds[1]);
+	}
+	close(fds[1]);
+	collect(conf, &run, pid, fds[0]);
+	csv_row(csv, conf, &run);
+	fprintf(stderr, "%s %ld %ld %ld %ld: %ld meals\n", conf->label, n,
+		s->die, s->eat, s->sleep, run.meals);
+	free(run.last_eat);
+	free(run.meals_per);
+	free(run.late);
+}
+
+static void	parse_args(t_conf *conf, int ac, char **av)
+{
+	int	i;
+
+	memset(conf, 0, sizeof(*conf));
+	conf->out = "bench.csv";
+	conf->label = "default";
+	conf->philo = "./philo";
+	conf->seconds = DEFAULT_SECONDS;
+	i = 0;
+	while (++i < ac)
+	{
+		if (!strncmp(av[i], "--out=", 6))
+			conf->out = av[i] + 6;
+		else if (!strncmp(av[i], "--label=", 8))
+			conf->label = av[i] + 8;
+		else if (!strncmp(av[i], "--philo=", 8))
+			conf->philo = av[i] + 8;
+		else if (!strncmp(av[i], "--seconds=", 10))
+			conf->seconds = atol(av[i] + 10);
+		else if (conf->flags_nbr < MAX_FLAGS)
+			conf->flags[conf->flags_nbr++] = av[i];
+		if (strstr(av[i], "--engine=coro") || strstr(av[i], "--virtual"))
+			conf->beyond = true;
+	}
+	if (conf->seconds < 1)
+		conf->seconds = DEFAULT_SECONDS;
+}
+
+/*
+ * Counts above PHILO_MAX only for the engines
+ * that accept them (coro, virtual time)
+*/
+int	main(int ac, char **av)
+{
+	t_conf	conf;
+	FILE	*csv;
+	size_t	t;
+	size_t	c;
+
+	parse_args(&conf, ac, av);
+	csv = fopen(conf.out, "w");
+	if (!csv)
+	{
+		perror(conf.out);
+		return (EXIT_FAILURE);
+	}
+	fprintf(csv, "label,philos,t_die,t_eat,t_sleep,sim_ms,meals,"
+		"meals_per_sec,late_p50_ms,late_p99_ms,late_max_ms,"
+		"death_latency_ms,user_ms,sys_ms,max_rss_kb,jain,meals_min,"
+		"meals_max,margin_ms\n");
+	t = -1;
+	while (++t < sizeof(g_tuples) / sizeof(*g_tuples))
+	{
+		c = -1;
+		while (++c < sizeof(g_counts) / sizeof(*g_counts))
+			run_one(csv, &conf, g_counts[c], g_tuples + t);
+		c = -1;
+		while (conf.beyond && ++c < sizeof(g_beyond) / sizeof(*g_beyond))
+			run_one(csv, &conf, g_beyond[c], g_tuples + t);
+	}
+	fclose(csv);
+	return (EXIT_SUCCESS);
+}
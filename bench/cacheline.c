@@ -0,0 +1,250 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+/*
+ * BEFORE / AFTER cache layout benchmark
+ *
+ * Reproduces the access pattern of the simulation on the
+ * philo array:
+ * 	~every philo thread publishes its own last meal and
+ * 		meals counter, reads its own fork pointers
+ * 	~the monitor thread reads every philo deadline back to back
+ *
+ * BEFORE: the old t_philo, packed back to back, the monitor
+ * 		reads last_meal_time + full inside the philos
+ * AFTER:  t_philo aligned to 64 bytes, the monitor scans
+ * 		a separate SoA deadline array
+ *
+ * Cache misses come from perf_event_open (whole process,
+ * all threads). No perf access (container, VM, paranoid
+ * level): only the ns/op is printed.
+ *
+ * ./cacheline [threads] [iterations]
+*/
+
+#define DEFAULT_THREADS 8
+#define DEFAULT_ITERS 20000000
+#define CACHE_LINE 64
+
+typedef struct s_packed
+{
+	int				id;
+	atomic_bool		full;
+	atomic_long		meals_counter;
+	atomic_long		last_meal_time;
+	void			*first_fork;
+	void			*second_fork;
+}				t_packed;
+
+typedef struct __attribute__((aligned(CACHE_LINE))) s_padded
+{
+	atomic_long		last_meal_time;
+	atomic_long		meals_counter;
+	atomic_bool		full;
+	int				id;
+	void			*first_fork;
+	void			*second_fork;
+}				t_padded;
+
+typedef struct s_bench
+{
+	t_packed		*packed;
+	t_padded		*padded;
+	atomic_long		*deadlines;
+	atomic_bool		stop;
+	long			threads;
+	long			iters;
+	bool			after;
+}				t_bench;
+
+typedef struct s_arg
+{
+	t_bench			*bench;
+	long			id;
+}				t_arg;
+
+static long	now_ns(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000000000L + ts.tv_nsec);
+}
+
+/*
+ * -1 if the kernel says no, inherit: counts the
+ * threads created after the open as well
+*/
+static int	perf_open(void)
+{
+	struct perf_event_attr	attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_HW_CACHE_MISSES;
+	attr.disabled = 1;
+	attr.inherit = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	return (syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+static void	*philo_like(void *data)
+{
+	t_arg	*arg;
+	t_bench	*b;
+	long	i;
+	long	sink;
+
+	arg = data;
+	b = arg->bench;
+	i = -1;
+	sink = 0;
+	while (++i < b->iters)
+	{
+		if (b->after)
+		{
+			atomic_store_explicit(&b->padded[arg->id].last_meal_time, i,
+				memory_order_release);
+			atomic_store_explicit(&b->deadlines[arg->id], i,
+				memory_order_release);
+			sink += (long)b->padded[arg->id].first_fork;
+			continue ;
+		}
+		atomic_store_explicit(&b->packed[arg->id].last_meal_time, i,
+			memory_order_release);
+		sink += (long)b->packed[arg->id].first_fork;
+	}
+	return ((void *)sink);
+}
+
+/*
+ * The monitor scan: deadlines only (AFTER)
+ * or full + last meal of every philo (BEFORE)
+*/
+static void	*monitor_like(void *data)
+{
+	t_bench	*b;
+	long	i;
+	long	sink;
+
+	b = data;
+	sink = 0;
+	while (!atomic_load_explicit(&b->stop, memory_order_acquire))
+	{
+		i = -1;
+		while (++i < b->threads)
+		{
+			if (b->after)
+				sink += atomic_load_explicit(&b->deadlines[i],
+						memory_order_acquire);
+			else if (!atomic_load_explicit(&b->packed[i].full,
+					memory_order_acquire))
+				sink += atomic_load_explicit(&b->packed[i].last_meal_time,
+						memory_order_acquire);
+		}
+	}
+	return ((void *)sink);
+}
+
+static double	run(t_bench *b, bool after, long long *misses)
+{
+	pthread_t	*th;
+	pthread_t	monitor;
+	t_arg		*args;
+	long		i;
+	long		start;
+	int			fd;
+
+	b->after = after;
+	atomic_store(&b->stop, false);
+	th = malloc(sizeof(pthread_t) * b->threads);
+	args = malloc(sizeof(t_arg) * b->threads);
+	if (!th || !args)
+		exit(EXIT_FAILURE);
+	fd = perf_open();
+	if (fd >= 0)
+		ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+	start = now_ns();
+	pthread_create(&monitor, NULL, monitor_like, b);
+	i = -1;
+	while (++i < b->threads)
+	{
+		args[i].bench = b;
+		args[i].id = i;
+		pthread_create(&th[i], NULL, philo_like, &args[i]);
+	}
+	i = -1;
+	while (++i < b->threads)
+		pthread_join(th[i], NULL);
+	atomic_store(&b->stop, true);
+	pthread_join(monitor, NULL);
+	start = now_ns() - start;
+	*misses = -1;
+	if (fd >= 0)
+	{
+		ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+		if (read(fd, misses, sizeof(*misses)) != sizeof(*misses))
+			*misses = -1;
+		close(fd);
+	}
+	free(th);
+	free(args);
+	return ((double)start / (b->iters * b->threads));
+}
+
+static void	print_run(const char *name, double ns, long long misses)
+{
+	if (misses < 0)
+		printf("%s: %8.2f ns/op, cache misses n/a\n", name, ns);
+	else
+		printf("%s: %8.2f ns/op, %12lld cache misses\n", name, ns, misses);
+}
+
+int	main(int ac, char **av)
+{
+	t_bench		b;
+	long long	before_misses;
+	long long	after_misses;
+	double		before;
+	double		after;
+
+	b.threads = DEFAULT_THREADS;
+	b.iters = DEFAULT_ITERS;
+	if (ac > 1)
+		b.threads = atol(av[1]);
+	if (ac > 2)
+		b.iters = atol(av[2]);
+	if (b.threads < 1 || b.iters < 1)
+		return (EXIT_FAILURE);
+	b.packed = calloc(b.threads, sizeof(t_packed));
+	b.padded = aligned_alloc(CACHE_LINE, b.threads * sizeof(t_padded));
+	b.deadlines = aligned_alloc(CACHE_LINE, CACHE_LINE
+			* ((b.threads * sizeof(atomic_long)) / CACHE_LINE + 1));
+	if (!b.packed || !b.padded || !b.deadlines)
+		return (EXIT_FAILURE);
+	memset(b.padded, 0, b.threads * sizeof(t_padded));
+	memset(b.deadlines, 0, b.threads * sizeof(atomic_long));
+	before = run(&b, false, &before_misses);
+	after = run(&b, true, &after_misses);
+	printf("threads %ld iterations %ld\n", b.threads, b.iters);
+	print_run("BEFORE packed philos ", before, before_misses);
+	print_run("AFTER  aligned + SoA ", after, after_misses);
+	if (before_misses > 0 && after_misses >= 0)
+		printf("cache misses x%.1f less\n",
+			(double)before_misses / (after_misses + 1));
+	free(b.packed);
+	free(b.padded);
+	free(b.deadlines);
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+
+/*
+ * BEFORE / AFTER contention benchmark
+ *
+ * Reproduces the access pattern of the simulation on the
+ * shared flags:
+ * 	~every philo thread reads end_simulation in a tight loop
+ * 		(simulation_finished in write_status, precise_usleep..)
+ * 	~every philo publishes its own last_meal_time
+ * 	~the monitor reads all the philos back to back
+ *
+ * BEFORE: the old getters, lock🔒 - read - unlock🔓
+ * AFTER:  the new getters, atomic ACQUIRE / RELEASE
+ *
+ * ./contention [threads] [iterations]
+ * Prints ns per getter call for both versions.
+*/
+
+#define DEFAULT_THREADS 16
+#define DEFAULT_ITERS 2000000
+
+typedef struct s_slot
+{
+	pthread_mutex_t	mtx;
+	long			value;
+	atomic_long		avalue;
+}				t_slot;
+
+typedef struct s_bench
+{
+	pthread_mutex_t	table_mtx;
+	bool			end;
+	atomic_bool		aend;
+	t_slot			*slots;
+	long			threads;
+	long			iters;
+	bool			atomic;
+}				t_bench;
+
+typedef struct s_arg
+{
+	t_bench			*bench;
+	long			id;
+}				t_arg;
+
+static long	now_ns(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000000000L + ts.tv_nsec);
+}
+
+/*
+ * One "philo": reads the end flag, every 64 reads
+ * publishes its own last meal
+*/
+static void	*philo_like(void *data)
+{
+	t_arg	*arg;
+	t_bench	*b;
+	long	i;
+	long	sink;
+
+	arg = data;
+	b = arg->bench;
+	i = -1;
+	sink = 0;
+	while (++i < b->iters)
+	{
+		if (b->atomic)
+			sink += atomic_load_explicit(&b->aend, memory_order_acquire);
+		else
+		{
+			pthread_mutex_lock(&b->table_mtx);
+			sink += b->end;
+			pthread_mutex_unlock(&b->table_mtx);
+		}
+		if (i % 64)
+			continue ;
+		if (b->atomic)
+			atomic_store_explicit(&b->slots[arg->id].avalue, i,
+				memory_order_release);
+		else
+		{
+			pthread_mutex_lock(&b->slots[arg->id].mtx);
+			b->slots[arg->id].value = i;
+			pthread_mutex_unlock(&b->slots[arg->id].mtx);
+		}
+	}
+	return ((void *)sink);
+}
+
+static double	run(t_bench *b, bool atomic)
+{
+	pthread_t	*th;
+	t_arg		*args;
+	long		i;
+	long		start;
+
+	b->atomic = atomic;
+	th = malloc(sizeof(pthread_t) * b->threads);
+	args = malloc(sizeof(t_arg) * b->threads);
+	if (!th || !args)
+		exit(EXIT_FAILURE);
+	start = now_ns();
+	i = -1;
+	while (++i < b->threads)
+	{
+		args[i].bench = b;
+		args[i].id = i;
+		pthread_create(&th[i], NULL, philo_like, &args[i]);
+	}
+	i = -1;
+	while (++i < b->threads)
+		pthread_join(th[i], NULL);
+	start = now_ns() - start;
+	free(th);
+	free(args);
+	return ((double)start / (b->iters * b->threads));
+}
+
+int	main(int ac, char **av)
+{
+	t_bench	b;
+	long	i;
+	double	before;
+	double	after;
+
+	b.threads = DEFAULT_THREADS;
+	b.iters = DEFAULT_ITERS;
+	if (ac > 1)
+		b.threads = atol(av[1]);
+	if (ac > 2)
+		b.iters = atol(av[2]);
+	if (b.threads < 1 || b.iters < 1)
+		return (EXIT_FAILURE);
+	b.slots = malloc(sizeof(t_slot) * b.threads);
+	if (!b.slots)
+		return (EXIT_FAILURE);
+	pthread_mutex_init(&b.table_mtx, NULL);
+	b.end = false;
+	atomic_init(&b.aend, false);
+	i = -1;
+	while (++i < b.threads)
+	{
+		pthread_mutex_init(&b.slots[i].mtx, NULL);
+		atomic_init(&b.slots[i].avalue, 0);
+	}
+	before = run(&b, false);
+	after = run(&b, true);
+	printf("threads %ld iterations %ld\n", b.threads, b.iters);
+	printf("BEFORE mutex getters : %8.2f ns/op\n", before);
+	printf("AFTER  atomic getters: %8.2f ns/op (x%.1f)\n", after,
+		before / after);
+	free(b.slots);
+	return (EXIT_SUCCESS);
+}
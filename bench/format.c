@@ -0,0 +1,178 @@
+#include "../philo.h"
+
+/*
+ * FORMATTER benchmark, printf against the templates
+ *
+ * ref_format is the old format.c: one snprintf per line.
+ * format_event is the template one, linked from ../format.c.
+ *
+ * 1) same bytes: every status, normal and debug, elapsed
+ * 		from 0 to past 6 digits, ids and aux up to 7 digits
+ * 2) lines per second of both, same events, the lines go
+ * 		in a 64KB batch like the writer thread does
+ *
+ * ./format [millions of lines]
+*/
+
+#define DEFAULT_MILLIONS 5
+#define BATCH 65536
+#define EVENTS 4096
+
+static int	ref_debug(char *buf, t_event *ev, long elapsed)
+{
+	if (TAKE_FIRST_FORK == ev->status)
+		return (snprintf(buf, LOG_LINE_MAX, W"%6ld"RST
+				" %d has taken the 1° fork 🍽""\t\t\tn°"B"[🍴 %ld 🍴]\n"RST,
+				elapsed, ev->philo_id, ev->aux));
+	else if (TAKE_SECOND_FORK == ev->status)
+		return (snprintf(buf, LOG_LINE_MAX, W"%6ld"RST
+				" %d has taken the 2° fork 🍽""\t\t\tn°"B"[🍴 %ld 🍴]\n"RST,
+				elapsed, ev->philo_id, ev->aux));
+	else if (EATING == ev->status)
+		return (snprintf(buf, LOG_LINE_MAX, W"%6ld"C" %d is eating 🍝"
+				"\t\t\t"Y"[🍝 %ld 🍝]\n"RST, elapsed, ev->philo_id, ev->aux));
+	else if (SLEEPING == ev->status)
+		return (snprintf(buf, LOG_LINE_MAX, W"%6ld"RST" %d is sleeping 😴\n",
+				elapsed, ev->philo_id));
+	else if (THINKING == ev->status)
+		return (snprintf(buf, LOG_LINE_MAX, W"%6ld"RST" %d is thinking 🤔\n",
+				elapsed, ev->philo_id));
+	else if (DIED == ev->status)
+		return (snprintf(buf, LOG_LINE_MAX,
+				RED"\t\t💀💀💀 %6ld %d died   💀💀💀\n"RST,
+				elapsed, ev->philo_id));
+	return (0);
+}
+
+static int	ref_format(char *buf, t_event *ev, long start)
+{
+	long	elapsed;
+
+	elapsed = (ev->time - start) / NSEC_PER_MSEC;
+	if (ev->debug)
+		return (ref_debug(buf, ev, elapsed));
+	if (TAKE_FIRST_FORK == ev->status || TAKE_SECOND_FORK == ev->status)
+		return (snprintf(buf, LOG_LINE_MAX, W"%-6ld"RST" %d has taken a fork\n",
+				elapsed, ev->philo_id));
+	else if (EATING == ev->status)
+		return (snprintf(buf, LOG_LINE_MAX, W"%-6ld"C" %d is eating\n"RST,
+				elapsed, ev->philo_id));
+	else if (SLEEPING == ev->status)
+		return (snprintf(buf, LOG_LINE_MAX, W"%-6ld"RST" %d is sleeping\n",
+				elapsed, ev->philo_id));
+	else if (THINKING == ev->status)
+		return (snprintf(buf, LOG_LINE_MAX, W"%-6ld"RST" %d is thinking\n",
+				elapsed, ev->philo_id));
+	else if (DIED == ev->status)
+		return (snprintf(buf, LOG_LINE_MAX, RED"%-6ld %d died\n"RST,
+				elapsed, ev->philo_id));
+	return (0);
+}
+
+static int	tpl_format(char *buf, t_event *ev, long start)
+{
+	return (format_event(buf, ev, start, false));
+}
+
+static long	now_ns(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000000000L + ts.tv_nsec);
+}
+
+/*
+ * The i-th event of the sweep, cheap and deterministic
+*/
+static void	event_at(t_event *ev, long i)
+{
+	static const long	times[] = {0, 7, 42, 999, 1000, 99999, 100000,
+		999999, 1000000, 12345678};
+
+	ev->status = i % 6;
+	ev->debug = (i / 6) % 2;
+	ev->time = times[(i / 12) % 10] * NSEC_PER_MSEC + i % NSEC_PER_MSEC;
+	ev->philo_id = 1 + (i * 7919) % 1000000;
+	ev->aux = (i * 104729) % 10000000;
+}
+
+static int	check(void)
+{
+	char	a[LOG_LINE_MAX];
+	char	b[LOG_LINE_MAX];
+	t_event	ev;
+	long	i;
+	int		la;
+	int		lb;
+
+	i = -1;
+	while (++i < 240000)
+	{
+		event_at(&ev, i);
+		la = ref_format(a, &ev, 0);
+		lb = format_event(b, &ev, 0, false);
+		if (la != lb || memcmp(a, b, la))
+		{
+			printf("MISMATCH status %d debug %d:\n%.*s%.*s", ev.status,
+				ev.debug, la, a, lb, b);
+			return (1);
+		}
+	}
+	printf("same bytes: %ld lines, normal and debug\n", i);
+	return (0);
+}
+
+/*
+ * Normal lines only, the default output.
+ * The events are built before the clock starts
+*/
+static double	lines_per_sec(int (*fmt)(char *, t_event *, long), long n,
+	long *sink)
+{
+	static char		batch[BATCH];
+	static t_event	evs[EVENTS];
+	long			len;
+	long			i;
+	long			t0;
+
+	i = -1;
+	while (++i < EVENTS)
+		event_at(evs + i, (i / 6) * 12 + i % 6);
+	len = 0;
+	t0 = now_ns();
+	i = -1;
+	while (++i < n)
+	{
+		if (len > BATCH - LOG_LINE_MAX)
+		{
+			*sink += batch[len / 2];
+			len = 0;
+		}
+		len += fmt(batch + len, evs + (i & (EVENTS - 1)), 0);
+	}
+	return (n / ((now_ns() - t0) / 1e9));
+}
+
+int	main(int ac, char **av)
+{
+	long	n;
+	long	sink;
+	double	ref;
+	double	tpl;
+
+	n = DEFAULT_MILLIONS;
+	if (ac > 1)
+		n = atol(av[1]);
+	if (n < 1)
+		n = 1;
+	n *= 1000000;
+	if (check())
+		return (EXIT_FAILURE);
+	sink = 0;
+	ref = lines_per_sec(ref_format, n, &sink);
+	tpl = lines_per_sec(tpl_format, n, &sink);
+	printf("snprintf:  %6.1f M lines/s\n", ref / 1e6);
+	printf("templates: %6.1f M lines/s  x%.1f\n", tpl / 1e6, tpl / ref);
+	return (sink == 42);
+}
@@ -0,0 +1,106 @@
+#include "../libphilo.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ * LIBPHILO benchmark, the same dinner N times
+ *
+ * 1) cold: create + run + destroy every time, what a sweep
+ * 		of ./philo processes pays, minus the exec
+ * 2) warm: one table, N runs, the threads come from the pool
+ * 		and the spin window is calibrated once
+ *
+ * Both count the events of the callback: same dinner,
+ * about the same count, nothing written anywhere.
+ *
+ * ./lib runs [--options] philo_nbr t_die t_eat t_sleep [meals]
+ * ./lib 50 200 800 60 60 1
+*/
+
+static long	now_ns(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000000000L + ts.tv_nsec);
+}
+
+/*
+ * One writer thread per table: a plain counter is enough
+*/
+static void	count_event(const t_philo_event *ev, void *ctx)
+{
+	(void)ev;
+	(*(long *)ctx)++;
+}
+
+static int	refused(t_philo_table *t)
+{
+	fprintf(stderr, "refused: %s\n", philo_table_error(t));
+	philo_table_destroy(t);
+	return (EXIT_FAILURE);
+}
+
+static long	cold(long runs, int ac, char **av, long *events)
+{
+	t_philo_table	*t;
+	t_philo_result	res;
+	long			t0;
+	long			i;
+
+	t0 = now_ns();
+	i = -1;
+	while (++i < runs)
+	{
+		if (philo_table_create(&t, ac, av, count_event, events) != PHILO_OK)
+			exit(refused(t));
+		philo_table_run(t, &res);
+		philo_table_destroy(t);
+	}
+	return (now_ns() - t0);
+}
+
+static long	warm(long runs, int ac, char **av, long *events)
+{
+	t_philo_table	*t;
+	t_philo_result	res;
+	long			t0;
+	long			i;
+
+	t0 = now_ns();
+	if (philo_table_create(&t, ac, av, count_event, events) != PHILO_OK)
+		exit(refused(t));
+	i = -1;
+	while (++i < runs)
+		philo_table_run(t, &res);
+	philo_table_destroy(t);
+	return (now_ns() - t0);
+}
+
+int	main(int ac, char **av)
+{
+	long	runs;
+	long	ev_cold;
+	long	ev_warm;
+	long	t_cold;
+	long	t_warm;
+
+	if (ac < 6)
+	{
+		fprintf(stderr, "./lib runs [--options] philo_nbr t_die t_eat "
+			"t_sleep [meals]\n");
+		return (EXIT_FAILURE);
+	}
+	runs = atol(av[1]);
+	if (runs < 1)
+		runs = 1;
+	ev_cold = 0;
+	ev_warm = 0;
+	t_cold = cold(runs, ac - 1, av + 1, &ev_cold);
+	t_warm = warm(runs, ac - 1, av + 1, &ev_warm);
+	printf("cold: %6.2f ms/run  %ld events\n", t_cold / 1e6 / runs, ev_cold);
+	printf("warm: %6.2f ms/run  %ld events  x%.2f\n", t_warm / 1e6 / runs,
+		ev_warm, (double)t_cold / t_warm);
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,122 @@
+#include "philo.h"
+
+/*
+ * CORO engine, coroutine side
+ *
+ * A coroutine never blocks its worker thread:
+ * it writes in coro->state what it needs and switches
+ * back to the scheduler loop (coro_after_switch does the rest
+ * once the coroutine stack is not in use anymore).
+*/
+static void	switch_to_scheduler(t_coro *coro, t_coro_state state)
+{
+	coro->state = state;
+	swapcontext(&coro->ctx, &coro->worker->sched_ctx);
+}
+
+/*
+ * Timed yield: the worker puts me in its timer heap.
+ * After the end of the simulation nobody sleeps anymore
+*/
+void	coro_sleep_until(t_coro *coro, long deadline)
+{
+	if (simulation_finished(coro->philo->table)
+		|| gettime(NANOSECOND) >= deadline)
+		return ;
+	coro->wake = deadline;
+	switch_to_scheduler(coro, CORO_SLEEP);
+}
+
+/*
+ * Fast path: fork free, take it.
+ * Slow path: park, the scheduler registers me as waiter
+ * and the owner hands me the fork in coro_drop_fork.
+ * When I run again the fork is already mine
+*/
+void	coro_take_fork(t_coro *coro, t_fork *fork)
+{
+	safe_mutex_handle(&fork->fork, LOCK);
+	if (NULL == fork->owner)
+	{
+		fork->owner = coro;
+		safe_mutex_handle(&fork->fork, UNLOCK);
+		return ;
+	}
+	safe_mutex_handle(&fork->fork, UNLOCK);
+	coro->park_fork = fork;
+	switch_to_scheduler(coro, CORO_PARK);
+}
+
+/*
+ * Hand the fork to the waiter, if any,
+ * and make him runnable on my worker
+*/
+void	coro_drop_fork(t_coro *coro, t_fork *fork)
+{
+	t_coro	*waiter;
+
+	safe_mutex_handle(&fork->fork, LOCK);
+	waiter = fork->waiter;
+	fork->waiter = NULL;
+	fork->owner = waiter;
+	safe_mutex_handle(&fork->fork, UNLOCK);
+	if (waiter)
+		coro_enqueue(coro->worker, waiter);
+}
+
+/*
+ * First function of every coroutine.
+ * makecontext only passes ints, the pointer
+ * travels in 2 halves
+*/
+static void	coro_entry(unsigned int hi, unsigned int lo)
+{
+	t_coro	*coro;
+
+	coro = (t_coro *)(((uintptr_t)hi << 32) | (uintptr_t)lo);
+	if (1 == coro->philo->table->philo_nbr)
+		lone_philo(coro->philo);
+	else
+		dinner_simulation(coro->philo);
+	switch_to_scheduler(coro, CORO_DONE);
+}
+
+/*
+ * getcontext returns twice, keep it in a function
+ * with nothing to clobber
+*/
+static void	make_coro(t_coro *coro, char *stack)
+{
+	uintptr_t	ptr;
+
+	if (getcontext(&coro->ctx))
+		error_exit("getcontext failed");
+	coro->ctx.uc_stack.ss_sp = stack;
+	coro->ctx.uc_stack.ss_size = CORO_STACK_SIZE;
+	coro->ctx.uc_link = NULL;
+	ptr = (uintptr_t)coro;
+	makecontext(&coro->ctx, (void (*)(void))coro_entry, 2,
+		(unsigned int)(ptr >> 32), (unsigned int)ptr);
+}
+
+/*
+ * Give every philo a coroutine and a slice of the big stack
+ * mapping, then spread them round robin on the workers
+*/
+void	coro_spawn_all(t_table *table)
+{
+	long		i;
+	t_coro		*coro;
+
+	i = -1;
+	while (++i < table->philo_nbr)
+	{
+		coro = table->sched.coros + i;
+		coro->philo = table->philos + i;
+		coro->idx = i;
+		coro->worker = table->sched.workers + i % table->opt.workers;
+		table->philos[i].coro = coro;
+		make_coro(coro, table->sched.stacks + i * CORO_STACK_SIZE);
+		coro_enqueue(coro->worker, coro);
+	}
+}
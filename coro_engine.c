@@ -0,0 +1,98 @@
+#include "philo.h"
+
+/*
+ * CORO engine, M:N
+ * philo_nbr coroutines on opt.workers threads (1 per core by
+ * default), so the philos count is not bounded by OS threads.
+ *
+ * 💡 The coroutines run the exact same dinner_simulation of the
+ * 	THREAD engine: fork waits and sleeps go through forks.c and
+ * 	become a yield to the scheduler 💡
+ *
+ * 🚨 No tsan here (DEBUG_MODE), it does not follow swapcontext 🚨
+*/
+
+static void	worker_init(t_table *table, t_worker *worker, long id)
+{
+	worker->id = id;
+	worker->table = table;
+	worker->queue = safe_malloc(table->philo_nbr * sizeof(t_coro *));
+	worker->q_head = 0;
+	worker->q_size = 0;
+	worker->timers.nodes = safe_malloc(table->philo_nbr
+			* sizeof(t_deadline));
+	worker->timers.size = 0;
+	worker->ring = table->log.rings + id;
+	safe_mutex_handle(&worker->queue_mutex, INIT);
+}
+
+/*
+ * All the stacks in ONE lazy mapping:
+ * ~MAP_NORESERVE, pages exist only once touched
+ * ~one mapping, not 100k (vm.max_map_count)
+ * ~0 philos, no mapping: mmap of 0 bytes is EINVAL
+*/
+void	coro_init(t_table *table)
+{
+	t_sched	*sched;
+	long	i;
+
+	sched = &table->sched;
+	atomic_init(&sched->done, 0);
+	sched->workers = safe_malloc(table->opt.workers * sizeof(t_worker));
+	sched->coros = safe_malloc(table->philo_nbr * sizeof(t_coro));
+	sched->stacks_len = (size_t)table->philo_nbr * CORO_STACK_SIZE;
+	sched->stacks = NULL;
+	if (sched->stacks_len)
+		sched->stacks = mmap(NULL, sched->stacks_len, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (MAP_FAILED == sched->stacks)
+		error_exit("mmap of the coroutine stacks failed");
+	i = -1;
+	while (++i < table->opt.workers)
+		worker_init(table, sched->workers + i, i);
+	coro_spawn_all(table);
+}
+
+void	coro_destroy(t_table *table)
+{
+	long	i;
+
+	i = -1;
+	while (++i < table->opt.workers)
+	{
+		free(table->sched.workers[i].queue);
+		free(table->sched.workers[i].timers.nodes);
+		safe_mutex_handle(&table->sched.workers[i].queue_mutex, DESTROY);
+	}
+	if (table->sched.stacks)
+		munmap(table->sched.stacks, table->sched.stacks_len);
+	free(table->sched.coros);
+	free(table->sched.workers);
+}
+
+/*
+ * Same choreography of dinner_start, with workers
+ * instead of philo threads
+*/
+void	coro_dinner_start(t_table *table)
+{
+	long	i;
+
+	i = -1;
+	while (++i < table->opt.workers)
+		dinner_thread_handle(table, &table->sched.workers[i].thread,
+			coro_worker, table->sched.workers + i, CREATE);
+	monitors_start(table);
+	dinner_thread_handle(table, &table->log.writer, log_writer, table, CREATE);
+	affinity_apply(table);
+	gate_open(table);
+	i = -1;
+	while (++i < table->opt.workers)
+		dinner_thread_handle(table, &table->sched.workers[i].thread,
+			NULL, NULL, JOIN);
+	stop_simulation(table);
+	monitors_join(table);
+	log_close(table);
+	dinner_thread_handle(table, &table->log.writer, NULL, NULL, JOIN);
+}
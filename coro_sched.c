@@ -0,0 +1,148 @@
+#include "philo.h"
+
+/*
+ * CORO engine, scheduler side
+ *
+ * Every worker thread loops:
+ * 1) timers: expired sleepers become runnable
+ * 		(all of them after the end of the simulation)
+ * 2) pop a runnable coroutine from its own queue,
+ * 		or STEAL one from the back of another worker queue
+ * 3) run it until it switches back, then do what it asked
+ * 4) nothing to do: nap until the next timer, CORO_IDLE_NS max
+ *
+ * The queue is a ring buffer of philo_nbr slots: a coroutine
+ * is in one queue at most, so it can never overflow.
+*/
+void	coro_enqueue(t_worker *worker, t_coro *coro)
+{
+	long	n;
+
+	n = worker->table->philo_nbr;
+	safe_mutex_handle(&worker->queue_mutex, LOCK);
+	worker->queue[(worker->q_head + worker->q_size++) % n] = coro;
+	safe_mutex_handle(&worker->queue_mutex, UNLOCK);
+}
+
+/*
+ * Owner pops from the front (FIFO, fair),
+ * thieves from the back
+*/
+static t_coro	*dequeue(t_worker *worker, bool steal)
+{
+	t_coro	*coro;
+	long	n;
+
+	coro = NULL;
+	n = worker->table->philo_nbr;
+	safe_mutex_handle(&worker->queue_mutex, LOCK);
+	if (worker->q_size > 0 && steal)
+		coro = worker->queue[(worker->q_head + --worker->q_size) % n];
+	else if (worker->q_size > 0)
+	{
+		coro = worker->queue[worker->q_head];
+		worker->q_head = (worker->q_head + 1) % n;
+		worker->q_size--;
+	}
+	safe_mutex_handle(&worker->queue_mutex, UNLOCK);
+	return (coro);
+}
+
+static t_coro	*next_coro(t_worker *worker)
+{
+	t_coro	*coro;
+	long	i;
+	long	nbr;
+
+	coro = dequeue(worker, false);
+	nbr = worker->table->opt.workers;
+	i = 0;
+	while (NULL == coro && ++i < nbr)
+		coro = dequeue(worker->table->sched.workers
+				+ (worker->id + i) % nbr, true);
+	return (coro);
+}
+
+/*
+ * The coroutine is switched out, its stack is free:
+ * now it's safe to publish it somewhere another
+ * worker could pick it up
+*/
+void	coro_after_switch(t_worker *worker, t_coro *coro)
+{
+	t_fork	*fork;
+	bool	got_it;
+
+	if (CORO_READY == coro->state)
+		coro_enqueue(worker, coro);
+	else if (CORO_SLEEP == coro->state)
+		heap_push(&worker->timers, coro->wake, coro->idx);
+	else if (CORO_DONE == coro->state)
+		increase_long(&worker->table->sched.done);
+	else if (CORO_PARK == coro->state)
+	{
+		fork = coro->park_fork;
+		safe_mutex_handle(&fork->fork, LOCK);
+		got_it = (NULL == fork->owner);
+		if (got_it)
+			fork->owner = coro;
+		else
+			fork->waiter = coro;
+		safe_mutex_handle(&fork->fork, UNLOCK);
+		if (got_it)
+			coro_enqueue(worker, coro);
+	}
+}
+
+/*
+ * Timers whose deadline passed go back in the run queue.
+ * Returns the next deadline, or now + CORO_IDLE_NS
+*/
+static long	fire_timers(t_worker *worker)
+{
+	long	now;
+	bool	end;
+	t_coro	*coros;
+
+	now = gettime(NANOSECOND);
+	end = simulation_finished(worker->table);
+	coros = worker->table->sched.coros;
+	while (worker->timers.size
+		&& (end || worker->timers.nodes[0].when <= now))
+	{
+		coro_enqueue(worker, coros + worker->timers.nodes[0].philo_idx);
+		heap_pop(&worker->timers);
+	}
+	if (worker->timers.size
+		&& worker->timers.nodes[0].when < now + CORO_IDLE_NS)
+		return (worker->timers.nodes[0].when);
+	return (now + CORO_IDLE_NS);
+}
+
+/*
+ * WORKER thread
+*/
+void	*coro_worker(void *data)
+{
+	t_worker	*worker;
+	t_coro		*coro;
+	long		next;
+
+	worker = (t_worker *)data;
+	wait_all_threads(worker->table);
+	while (get_long(&worker->table->sched.done) < worker->table->philo_nbr)
+	{
+		next = fire_timers(worker);
+		coro = next_coro(worker);
+		if (NULL == coro)
+		{
+			end_sleep_until(worker->table, next);
+			continue ;
+		}
+		coro->worker = worker;
+		coro->philo->ring = worker->ring;
+		swapcontext(&worker->sched_ctx, &coro->ctx);
+		coro_after_switch(worker, coro);
+	}
+	return (NULL);
+}
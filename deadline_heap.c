@@ -0,0 +1,92 @@
+#include "philo.h"
+
+/*
+ * MIN-HEAP of death deadlines, used by the monitor
+ * to know which philo is the next one that could die.
+ *
+ * 	nodes[0] is always the earliest deadline
+ * 	children of i are 2i+1 and 2i+2
+ *
+ * O(log n) push and fix, O(1) peek
+ *
+ * Equal deadlines are ordered by tie, the VIRTUAL engine
+ * uses it as its seeded event queue
+*/
+
+static bool	earlier(t_deadline *a, t_deadline *b)
+{
+	if (a->when != b->when)
+		return (a->when < b->when);
+	return (a->tie < b->tie);
+}
+
+static void	swap_nodes(t_deadline *a, t_deadline *b)
+{
+	t_deadline	tmp;
+
+	tmp = *a;
+	*a = *b;
+	*b = tmp;
+}
+
+static void	sift_down(t_heap *heap, long i)
+{
+	long	smallest;
+	long	child;
+
+	while (1)
+	{
+		smallest = i;
+		child = 2 * i + 1;
+		if (child < heap->size
+			&& earlier(heap->nodes + child, heap->nodes + smallest))
+			smallest = child;
+		if (child + 1 < heap->size
+			&& earlier(heap->nodes + child + 1, heap->nodes + smallest))
+			smallest = child + 1;
+		if (smallest == i)
+			return ;
+		swap_nodes(heap->nodes + i, heap->nodes + smallest);
+		i = smallest;
+	}
+}
+
+void	heap_push_tie(t_heap *heap, long when, long philo_idx,
+		unsigned long tie)
+{
+	long	i;
+
+	i = heap->size++;
+	heap->nodes[i].when = when;
+	heap->nodes[i].philo_idx = philo_idx;
+	heap->nodes[i].tie = tie;
+	while (i > 0 && earlier(heap->nodes + i, heap->nodes + (i - 1) / 2))
+	{
+		swap_nodes(heap->nodes + i, heap->nodes + (i - 1) / 2);
+		i = (i - 1) / 2;
+	}
+}
+
+void	heap_push(t_heap *heap, long when, long philo_idx)
+{
+	heap_push_tie(heap, when, philo_idx, 0);
+}
+
+/*
+ * Remove the earliest deadline
+*/
+void	heap_pop(t_heap *heap)
+{
+	heap->nodes[0] = heap->nodes[--heap->size];
+	sift_down(heap, 0);
+}
+
+/*
+ * The earliest deadline moved later (the philo ate):
+ * new key for the root and let it sink
+*/
+void	heap_update_top(t_heap *heap, long when)
+{
+	heap->nodes[0].when = when;
+	sift_down(heap, 0);
+}
@@ -15,23 +15,53 @@
  * 	immediately eating after sleeping without 
  * 	waiting a little for neighbour philo. 
  * I tried many cases, but not sure if 100% robust.
+ *
+ * ⏰ Thinking ends at an absolute time: the end of the
+ * 	last sleep + think_time
+ *
+ * think_until is shared with the VIRTUAL engine,
+ * same policy with or without a real clock.
+ * --think=adaptive replaces the magic number, see think.c
 */
-void	thinking(t_philo *philo, bool pre_simulation)
+long	think_time(t_table *table)
 {
-	long	t_eat;
-	long	t_sleep;
 	long	t_think;
 
-	if (!pre_simulation)
-		write_status(THINKING, philo, DEBUG_MODE);
-	if (philo->table->philo_nbr % 2 == 0)
-		return ;
-	t_eat = philo->table->time_to_eat;
-	t_sleep = philo->table->time_to_sleep;
-	t_think = (t_eat * 2) - t_sleep;
+	if (table->philo_nbr % 2 == 0)
+		return (0);
+	t_think = (table->time_to_eat * 2) - table->time_to_sleep;
 	if (t_think < 0)
 		t_think = 0;
-	precise_usleep(t_think * 0.42, philo->table);
+	return (t_think * 42 / 100);
+}
+
+/*
+ * Absolute end of the thinking started at now,
+ * now itself if there is nothing to think about
+*/
+long	think_until(t_philo *philo, long now)
+{
+	long	t_think;
+
+	if (THINK_ADAPTIVE == philo->table->opt.think)
+		return (adaptive_think_until(philo, now));
+	t_think = think_time(philo->table);
+	if (0 == t_think)
+		return (now);
+	return (get_long(&philo->last_meal_time) + philo->table->time_to_eat
+		+ philo->table->time_to_sleep + t_think);
+}
+
+void	thinking(t_philo *philo)
+{
+	long	now;
+	long	end;
+
+	write_status(THINKING, philo, DEBUG_MODE);
+	now = gettime(NANOSECOND);
+	end = think_until(philo, now);
+	if (end > now)
+		philo_sleep_until(philo, end);
 }
 
 /*
@@ -47,80 +77,99 @@ void	*lone_philo(void *arg)
 	t_philo	*philo;
 
 	philo = (t_philo *)arg;
-	wait_all_threads(philo->table);
-	set_long(&philo->philo_mutex, &philo->last_meal_time, gettime(MILLISECOND));
-	increase_long(&philo->table->table_mutex,
-		&philo->table->threads_running_nbr);
+	if (NULL == philo->coro)
+		wait_all_threads(philo->table);
 	write_status(TAKE_FIRST_FORK, philo, DEBUG_MODE);
 	while (!simulation_finished(philo->table))
-		precise_usleep(200, philo->table);
+		philo_sleep_until(philo, LONG_MAX);
 	return (NULL);
 }
 
 /*
  * Eating routine
- * 1) Grab forks: here first & second fork is handy,
- * 		philo does not care if left or right
+ * 1) Grab forks: the --strategy decides how (strategy.c),
+ * 		default is first & second fork, philo does not
+ * 		care if left or right
  * 2) eat: write status & update meals_counter, last_meal_time, 
  * 		full bool. 
  * 3) release forks
  *
+ * 🚨 The end wakes every sleeper at once, the dead philo
+ * 	included: forks got after the end go back untouched,
+ * 	no meal, no full after the death 🚨
+ *
+ * ⏰ Every phase ends at an ABSOLUTE time computed from the
+ * 	meal start: eat until last_meal + t_eat, sleep until
+ * 	last_meal + t_eat + t_sleep, so nothing drifts
+ *
  * 💡 last_meal_time in my implementation
  * 			happens before Eating :
  * 		this is helpful to avoid deaths 
  * 		while a philo is eating 💡
  *
- * 🔒 All the variables update are thread safe
- * 	thanks to setters, 
- * 	cause monitor thread read these values 
- * 	concurrently 🔒
+ * 🔓 All the variables update are thread safe
+ * 	thanks to atomic setters,
+ * 	cause monitor thread read these values
+ * 	concurrently 🔓
 */
 static void	eat(t_philo *philo)
 {
-	safe_mutex_handle(&philo->first_fork->fork, LOCK);
-	write_status(TAKE_FIRST_FORK, philo, DEBUG_MODE);
-	safe_mutex_handle(&philo->second_fork->fork, LOCK);
-	write_status(TAKE_SECOND_FORK, philo, DEBUG_MODE);
-	set_long(&philo->philo_mutex, &philo->last_meal_time, gettime(MILLISECOND));
-	philo->meals_counter++;
+	long	now;
+
+	if (METRICS)
+		fairness_want(philo, gettime(NANOSECOND));
+	philo->table->opt.strategy->acquire(philo);
+	if (simulation_finished(philo->table))
+	{
+		philo->table->opt.strategy->release(philo);
+		return ;
+	}
+	now = gettime(NANOSECOND);
+	if (METRICS)
+		fairness_meal(philo, now);
+	if (THINK_ADAPTIVE == philo->table->opt.think)
+		adaptive_feedback(philo, now);
+	publish_meal(philo, now);
+	increase_long(&philo->meals_counter);
 	write_status(EATING, philo, DEBUG_MODE);
-	precise_usleep(philo->table->time_to_eat, philo->table);
+	philo_sleep_until(philo, get_long(&philo->last_meal_time)
+		+ philo->table->time_to_eat);
 	if (philo->table->nbr_limit_meals > 0
-		&& philo->meals_counter == philo->table->nbr_limit_meals)
-		set_bool(&philo->philo_mutex, &philo->full, true);
-	safe_mutex_handle(&philo->first_fork->fork, UNLOCK);
-	safe_mutex_handle(&philo->second_fork->fork, UNLOCK);
+		&& get_long(&philo->meals_counter) == philo->table->nbr_limit_meals
+		&& !simulation_finished(philo->table))
+		publish_full(philo);
+	philo->table->opt.strategy->release(philo);
+	trace_drops(philo, gettime(NANOSECOND));
 }
 
 /*
  * Actual dinner
- * 1) Wait for all threads to be ready
- * 2) Increase the number of running threads, useful for monitor
- * 3) de_synchronize_philos-> Useful for fairness
- * 4) Start an endless loop, until a philo eventually dies
+ * 1) Wait for all threads to be ready at the start gate,
+ * 		main already set my last_meal_time to the start.
+ * 		A coroutine does not: its worker already waited
+ * 2) de_synchronize_philos-> Useful for fairness
+ * 3) Start an endless loop, until a philo eventually dies
  * 		or becomes full. 
  * 💡  write_status will always check for end_simulation 
  *     flag before writing 💡
 */
-static void	*dinner_simulation(void *data)
+void	*dinner_simulation(void *data)
 {
 	t_philo		*philo;
 
 	philo = (t_philo *)data;
-	wait_all_threads(philo->table);
-	set_long(&philo->philo_mutex, &philo->last_meal_time,
-		gettime(MILLISECOND));
-	increase_long(&philo->table->table_mutex,
-		&philo->table->threads_running_nbr);
+	if (NULL == philo->coro)
+		wait_all_threads(philo->table);
 	de_synchronize_philos(philo);
 	while (!simulation_finished(philo->table))
 	{
-		if (get_bool(&philo->philo_mutex, &philo->full))
+		if (get_bool(&philo->full))
 			break ;
 		eat(philo);
 		write_status(SLEEPING, philo, DEBUG_MODE);
-		precise_usleep(philo->table->time_to_sleep, philo->table);
-		thinking(philo, false);
+		philo_sleep_until(philo, get_long(&philo->last_meal_time)
+			+ philo->table->time_to_eat + philo->table->time_to_sleep);
+		thinking(philo);
 	}
 	return (NULL);
 }
@@ -129,14 +178,16 @@ static void	*dinner_simulation(void *data)
  * 0) If no meals, return to main and clean
  * 0.1) If only one philo, create ad hoc thread 
  * 1) Create all the philosophers
- * 2) Create another one thread searching 
- * 		for death ones
- * 3) set time_start_simulation and 
- * 		set true ready all, so they can start simulation
+ * 2) Create the monitor threads searching
+ * 		for death ones, and the log writer thread
+ * 3) open the start gate: stamps time_start_simulation
+ * 		and wakes all the threads at once
  * 4) Wait for all
  * 5) If we pass line 164 it means all philos are full
  * 		so set end_simulation for monitor
- * 6) Wait for monitor as well. Then jump to clean in main
+ * 6) Wait for the monitors as well.
+ * 7) Close the log: the writer flushes the last batch
+ * 		and we can jump to clean in main
  *
  * 💡 If we join all threads it means they are all full,
  * so the simulation is finished, therefore we set the 
@@ -148,26 +199,93 @@ static void	*dinner_simulation(void *data)
  * 	~by monitor cause a philo died
  * 💡It's a "2 way" bool for threads communication 💡
 */
-void	dinner_start(t_table *table)
+static void	thread_dinner_start(t_table *table)
 {
 	int			i;
 
 	i = -1;
+	if (1 == table->philo_nbr)
+		dinner_thread_handle(table, &table->philos[0].thread_id,
+			lone_philo, &table->philos[0], CREATE);
+	else
+		while (++i < table->philo_nbr)
+			dinner_thread_handle(table, &table->philos[i].thread_id,
+				dinner_simulation, &table->philos[i], CREATE);
+	monitors_start(table);
+	dinner_thread_handle(table, &table->log.writer, log_writer, table, CREATE);
+	affinity_apply(table);
+	gate_open(table);
+	i = -1;
+	while (++i < table->philo_nbr)
+		dinner_thread_handle(table, &table->philos[i].thread_id,
+			NULL, NULL, JOIN);
+	stop_simulation(table);
+	monitors_join(table);
+	log_close(table);
+	dinner_thread_handle(table, &table->log.writer, NULL, NULL, JOIN);
+}
+
+/*
+ * Pick the engine, --engine=thread|coro or --virtual-time
+*/
+void	dinner_start(t_table *table)
+{
 	if (0 == table->nbr_limit_meals)
 		return ;
-	else if (1 == table->philo_nbr)
-		safe_thread_handle(&table->philos[0].thread_id, lone_philo,
-			&table->philos[0], CREATE);
+	if (METRICS)
+		table->metrics.create = gettime(MICROSECOND);
+	if (ENGINE_CORO == table->opt.engine)
+		coro_dinner_start(table);
+	else if (ENGINE_VIRTUAL == table->opt.engine)
+		virtual_dinner_start(table);
+	else if (ENGINE_PROCESS == table->opt.engine)
+		process_dinner_start(table);
 	else
-		while (++i < table->philo_nbr)
-			safe_thread_handle(&table->philos[i].thread_id, dinner_simulation,
-				&table->philos[i], CREATE);
-	safe_thread_handle(&table->monitor, monitor_dinner, table, CREATE);
-	table->start_simulation = gettime(MILLISECOND);
-	set_bool(&table->table_mutex, &table->all_threads_ready, true);
+		thread_dinner_start(table);
+	if (METRICS && table->metrics.died_at)
+		table->metrics.shutdown = gettime(NANOSECOND)
+			- table->metrics.died_at;
+	if (METRICS && table->log.fd >= 0)
+		metrics_report(table);
+}
+
+/*
+ * After the dinner, before clean.
+ * The death: log->death for the real engines,
+ * virt->dead for the VIRTUAL one
+*/
+void	table_outcome(t_table *table, t_result *res)
+{
+	long	i;
+	long	meals;
+
+	res->meals_min = 0;
+	res->meals_max = 0;
 	i = -1;
 	while (++i < table->philo_nbr)
-		safe_thread_handle(&table->philos[i].thread_id, NULL, NULL, JOIN);
-	set_bool(&table->table_mutex, &table->end_simulation, true);
-	safe_thread_handle(&table->monitor, NULL, NULL, JOIN);
+	{
+		meals = get_long(&table->philos[i].meals_counter);
+		if (0 == i || meals < res->meals_min)
+			res->meals_min = meals;
+		if (meals > res->meals_max)
+			res->meals_max = meals;
+	}
+	res->outcome = OUTCOME_SURVIVED;
+	if (ENGINE_VIRTUAL == table->opt.engine && -1 != table->virt.dead)
+	{
+		res->outcome = OUTCOME_DIED;
+		res->dead_id = table->philos[table->virt.dead].id;
+		res->died_ms = table->virt.now / NSEC_PER_MSEC;
+	}
+	else if (ENGINE_VIRTUAL != table->opt.engine
+		&& get_bool(&table->log.death_posted))
+	{
+		res->outcome = OUTCOME_DIED;
+		res->dead_id = table->log.death.philo_id;
+		res->died_ms = (table->log.death.time - table->start_simulation)
+			/ NSEC_PER_MSEC;
+	}
+	else if (table->nbr_limit_meals >= 0
+		&& res->meals_min >= table->nbr_limit_meals)
+		res->outcome = OUTCOME_FULL;
 }
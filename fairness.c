@@ -0,0 +1,144 @@
+#include "philo.h"
+
+/*
+ * FAIRNESS REPORT, METRICS=1
+ *
+ * Every philo keeps its own counters in table->fairness[i],
+ * one cache line each: eat() only adds plain stores to
+ * memory nobody else touches, no lock on the hot path.
+ * Main reads them after the join (happens-before).
+ *
+ * At exit:
+ * 	~Jain's index on the meals, (Σx)² / (n·Σx²), 1 is perfect
+ * 	~min / max meals
+ * 	~fork wait, average and worst
+ * 	~starvation margin: time_to_die - longest gap between 2 meals
+*/
+
+void	fairness_init(t_table *table)
+{
+	table->fairness = NULL;
+	if (!METRICS)
+		return ;
+	table->fairness = safe_aligned_malloc(table->philo_nbr
+			* sizeof(t_fairness));
+	memset(table->fairness, 0, table->philo_nbr * sizeof(t_fairness));
+}
+
+void	fairness_want(t_philo *philo, long now)
+{
+	philo->table->fairness[philo->id - 1].want = now;
+}
+
+/*
+ * Called with the forks in hand, BEFORE publish_meal:
+ * last_meal_time is still the previous meal
+*/
+void	fairness_meal(t_philo *philo, long now)
+{
+	t_fairness	*f;
+	long		wait;
+	long		gap;
+
+	f = philo->table->fairness + philo->id - 1;
+	wait = now - f->want;
+	f->wait_total += wait;
+	if (wait > f->wait_max)
+		f->wait_max = wait;
+	gap = now - get_long(&philo->last_meal_time);
+	if (gap > f->max_gap)
+		f->max_gap = gap;
+}
+
+/*
+ * Index of the philo with the min / max of a counter
+ * what: 'm' meals, 'g' max_gap, 'w' wait_max
+*/
+static long	pick(t_table *table, bool max, char what)
+{
+	long	i;
+	long	best;
+	long	value;
+	long	best_value;
+
+	best = 0;
+	best_value = 0;
+	i = -1;
+	while (++i < table->philo_nbr)
+	{
+		value = table->fairness[i].max_gap;
+		if ('m' == what)
+			value = get_long(&table->philos[i].meals_counter);
+		else if ('w' == what)
+			value = table->fairness[i].wait_max;
+		if (0 == i || (max && value > best_value)
+			|| (!max && value < best_value))
+		{
+			best = i;
+			best_value = value;
+		}
+	}
+	return (best);
+}
+
+/*
+ * The dead philo never got his next meal:
+ * his last gap ends at the death
+*/
+static void	account_death(t_table *table)
+{
+	long	idx;
+	long	when;
+
+	if (get_bool(&table->log.death_posted))
+	{
+		idx = table->log.death.philo_id - 1;
+		when = table->log.death.time;
+	}
+	else if (ENGINE_VIRTUAL == table->opt.engine && -1 != table->virt.dead)
+	{
+		idx = table->virt.dead;
+		when = table->virt.now;
+	}
+	else
+		return ;
+	when -= get_long(&table->philos[idx].last_meal_time);
+	if (when > table->fairness[idx].max_gap)
+		table->fairness[idx].max_gap = when;
+}
+
+void	fairness_report(t_table *table)
+{
+	double	sum;
+	double	sum_sq;
+	double	waits;
+	long	i;
+	long	worst;
+
+	account_death(table);
+	sum = 0;
+	sum_sq = 0;
+	waits = 0;
+	i = -1;
+	while (++i < table->philo_nbr)
+	{
+		sum += get_long(&table->philos[i].meals_counter);
+		sum_sq += (double)get_long(&table->philos[i].meals_counter)
+			* get_long(&table->philos[i].meals_counter);
+		waits += table->fairness[i].wait_total;
+	}
+	fprintf(stderr, "[metrics] fairness: jain %.4f, meals min %ld (philo "
+		"%ld) max %ld (philo %ld), fork wait avg %.1f us\n",
+		sum * sum / (table->philo_nbr * sum_sq + (0 == sum_sq)),
+		get_long(&table->philos[pick(table, false, 'm')].meals_counter),
+		pick(table, false, 'm') + 1,
+		get_long(&table->philos[pick(table, true, 'm')].meals_counter),
+		pick(table, true, 'm') + 1, waits / (sum + (0 == sum)) / 1e3);
+	worst = pick(table, true, 'g');
+	fprintf(stderr, "[metrics] starvation: worst margin %.1f ms (philo %ld, "
+		"gap %.1f ms), worst fork wait %.1f ms (philo %ld)\n",
+		(table->time_to_die - table->fairness[worst].max_gap) / 1e6,
+		worst + 1, table->fairness[worst].max_gap / 1e6,
+		table->fairness[pick(table, true, 'w')].wait_max / 1e6,
+		pick(table, true, 'w') + 1);
+}
@@ -0,0 +1,107 @@
+#include "philo.h"
+
+/*
+ * FORK LOCKS, --lock=name, THREAD engine
+ *
+ * A pthread mutex promises no order: the philo who just
+ * dropped the fork can take it back before the neighbour
+ * who was waiting, meal after meal, until he dies.
+ *
+ * 	~pthread	(default) the fork mutex
+ * 	~ticket		take a number, served in order: FIFO
+ * 	~mcs		queue of nodes, each waiter spins on its
+ * 				own node, FIFO too (fork_lock_mcs.c)
+ * 	~hybrid		one futex word, spin then sleep,
+ * 				not FIFO, no syscall without sleepers
+ *
+ * 💡 ticket, mcs and hybrid spin LOCK_SPIN times, then
+ * 	park on a futex: 2 philos share a fork, the waiter
+ * 	must not burn the core of the holder 💡
+*/
+
+static void	pthread_lock(t_philo *philo, t_fork *fork)
+{
+	(void)philo;
+	safe_mutex_handle(&fork->fork, LOCK);
+}
+
+static bool	pthread_try(t_philo *philo, t_fork *fork)
+{
+	(void)philo;
+	return (0 == pthread_mutex_trylock(&fork->fork));
+}
+
+static void	pthread_unlock(t_philo *philo, t_fork *fork)
+{
+	(void)philo;
+	safe_mutex_handle(&fork->fork, UNLOCK);
+}
+
+/*
+ * Parked waiters sleep on serving while it is not their number
+*/
+static void	ticket_lock(t_philo *philo, t_fork *fork)
+{
+	unsigned int	mine;
+	unsigned int	now;
+	int				spin;
+
+	(void)philo;
+	mine = atomic_fetch_add(&fork->ticket.next, 1);
+	spin = 0;
+	while (atomic_load(&fork->ticket.serving) != mine && spin++ < LOCK_SPIN)
+		cpu_relax();
+	if (atomic_load(&fork->ticket.serving) == mine)
+		return ;
+	atomic_fetch_add(&fork->ticket.parked, 1);
+	now = atomic_load(&fork->ticket.serving);
+	while (now != mine)
+	{
+		futex_wait(&fork->ticket.serving, now);
+		now = atomic_load(&fork->ticket.serving);
+	}
+	atomic_fetch_sub(&fork->ticket.parked, 1);
+}
+
+static bool	ticket_try(t_philo *philo, t_fork *fork)
+{
+	unsigned int	serving;
+
+	(void)philo;
+	serving = atomic_load(&fork->ticket.serving);
+	return (atomic_compare_exchange_strong(&fork->ticket.next, &serving,
+			serving + 1));
+}
+
+/*
+ * The store of serving and the load of parked are seq_cst,
+ * like the waiter increment then load: one of the 2 sees the other
+*/
+static void	ticket_unlock(t_philo *philo, t_fork *fork)
+{
+	(void)philo;
+	atomic_fetch_add(&fork->ticket.serving, 1);
+	if (atomic_load(&fork->ticket.parked))
+		futex_wake(&fork->ticket.serving, INT_MAX);
+}
+
+static const t_fork_lock	g_locks[] = {
+{"pthread", pthread_lock, pthread_try, pthread_unlock},
+{"ticket", ticket_lock, ticket_try, ticket_unlock},
+{"mcs", mcs_lock, mcs_try, mcs_unlock},
+{"hybrid", hybrid_lock, hybrid_try, hybrid_unlock},
+};
+
+const t_fork_lock	*lock_find(const char *name)
+{
+	size_t	i;
+
+	i = 0;
+	while (i < sizeof(g_locks) / sizeof(*g_locks))
+	{
+		if (!strcmp(name, g_locks[i].name))
+			return (g_locks + i);
+		i++;
+	}
+	return (NULL);
+}
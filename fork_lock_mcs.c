@@ -0,0 +1,127 @@
+#include "philo.h"
+
+/*
+ * MCS LOCK, --lock=mcs
+ * The fork keeps only the tail of a queue of nodes.
+ * A waiter links its node behind the tail and spins on
+ * its OWN node: the holder flips it when dropping the fork,
+ * only that cache line moves. FIFO like the ticket lock.
+ *
+ * The node must live until the unlock: philo->mcs[0] for
+ * the first fork, [1] for the second, a philo holds 2 forks max
+*/
+static t_mcs_node	*node_of(t_philo *philo, t_fork *fork)
+{
+	return (philo->mcs + (fork == philo->second_fork));
+}
+
+void	mcs_lock(t_philo *philo, t_fork *fork)
+{
+	t_mcs_node	*node;
+	t_mcs_node	*prev;
+	int			spin;
+
+	node = node_of(philo, fork);
+	atomic_store(&node->next, NULL);
+	atomic_store(&node->locked, 1);
+	atomic_store(&node->parked, 0);
+	prev = atomic_exchange(&fork->tail, node);
+	if (NULL == prev)
+		return ;
+	atomic_store(&prev->next, node);
+	spin = 0;
+	while (atomic_load(&node->locked) && spin++ < LOCK_SPIN)
+		cpu_relax();
+	if (!atomic_load(&node->locked))
+		return ;
+	atomic_store(&node->parked, 1);
+	while (atomic_load(&node->locked))
+		futex_wait(&node->locked, 1);
+}
+
+bool	mcs_try(t_philo *philo, t_fork *fork)
+{
+	t_mcs_node	*node;
+	t_mcs_node	*empty;
+
+	node = node_of(philo, fork);
+	atomic_store(&node->next, NULL);
+	atomic_store(&node->locked, 0);
+	atomic_store(&node->parked, 0);
+	empty = NULL;
+	return (atomic_compare_exchange_strong(&fork->tail, &empty, node));
+}
+
+/*
+ * No successor: empty the queue, unless one is
+ * linking himself right now, then wait for his link
+*/
+void	mcs_unlock(t_philo *philo, t_fork *fork)
+{
+	t_mcs_node	*node;
+	t_mcs_node	*next;
+	t_mcs_node	*expected;
+
+	node = node_of(philo, fork);
+	next = atomic_load(&node->next);
+	if (NULL == next)
+	{
+		expected = node;
+		if (atomic_compare_exchange_strong(&fork->tail, &expected, NULL))
+			return ;
+		next = atomic_load(&node->next);
+		while (NULL == next)
+		{
+			cpu_relax();
+			next = atomic_load(&node->next);
+		}
+	}
+	atomic_store(&next->locked, 0);
+	if (atomic_load(&next->parked))
+		futex_wake(&next->locked, 1);
+}
+
+/*
+ * HYBRID LOCK, --lock=hybrid
+ * One futex word: 0 free, 1 taken, 2 taken and somebody
+ * may sleep. Spin first, the fork often comes back in a
+ * few hundred ns; then sleep in the kernel.
+ * The unlock makes a syscall only if the word was 2
+*/
+void	hybrid_lock(t_philo *philo, t_fork *fork)
+{
+	unsigned int	c;
+	int				spin;
+
+	(void)philo;
+	spin = 0;
+	while (spin++ < LOCK_SPIN)
+	{
+		c = 0;
+		if (atomic_compare_exchange_weak(&fork->word, &c, 1))
+			return ;
+		cpu_relax();
+	}
+	c = atomic_exchange(&fork->word, 2);
+	while (c)
+	{
+		futex_wait(&fork->word, 2);
+		c = atomic_exchange(&fork->word, 2);
+	}
+}
+
+bool	hybrid_try(t_philo *philo, t_fork *fork)
+{
+	unsigned int	c;
+
+	(void)philo;
+	c = 0;
+	return (atomic_compare_exchange_strong(&fork->word, &c, 1));
+}
+
+void	hybrid_unlock(t_philo *philo, t_fork *fork)
+{
+	(void)philo;
+	if (2 == atomic_exchange(&fork->word, 0))
+		futex_wake(&fork->word, 1);
+}
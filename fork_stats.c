@@ -0,0 +1,100 @@
+#include "philo.h"
+
+/*
+ * FORK LOCK STATS, METRICS=1
+ * take_fork / drop_fork record, for every fork:
+ * 	~wait: how long the philo waited for it (histogram)
+ * 	~hold: how long he kept it
+ * Only the holder writes the counters of a fork,
+ * main reads them after the join.
+ *
+ * At exit: the wait tail of all the forks together,
+ * the average hold, the worst forks. Same report for
+ * every --lock, compare them on the same dinner
+*/
+
+void	fork_stats_init(t_table *table)
+{
+	long	i;
+
+	table->fork_stats = NULL;
+	if (!METRICS)
+		return ;
+	table->fork_stats = safe_aligned_malloc(table->philo_nbr
+			* sizeof(t_fork_stats));
+	memset(table->fork_stats, 0, table->philo_nbr * sizeof(t_fork_stats));
+	i = -1;
+	while (++i < table->philo_nbr)
+		hist_init(&table->fork_stats[i].wait);
+}
+
+void	fork_stats_taken(t_table *table, t_fork *fork, long since)
+{
+	t_fork_stats	*s;
+
+	s = table->fork_stats + fork->fork_id;
+	s->taken = gettime(NANOSECOND);
+	hist_record(&s->wait, s->taken - since);
+}
+
+void	fork_stats_dropped(t_table *table, t_fork *fork)
+{
+	t_fork_stats	*s;
+	long			hold;
+
+	s = table->fork_stats + fork->fork_id;
+	hold = gettime(NANOSECOND) - s->taken;
+	s->hold_total += hold;
+	if (hold > s->hold_max)
+		s->hold_max = hold;
+}
+
+/*
+ * Index of the fork with the worst wait / hold
+*/
+static long	worst(t_table *table, bool hold)
+{
+	long	i;
+	long	best;
+
+	best = 0;
+	i = 0;
+	while (++i < table->philo_nbr)
+	{
+		if (hold && table->fork_stats[i].hold_max
+			> table->fork_stats[best].hold_max)
+			best = i;
+		else if (!hold && table->fork_stats[i].wait.max
+			> table->fork_stats[best].wait.max)
+			best = i;
+	}
+	return (best);
+}
+
+void	fork_stats_report(t_table *table)
+{
+	t_hist	wait;
+	long	hold;
+	long	i;
+	char	name[64];
+
+	hist_init(&wait);
+	hold = 0;
+	i = -1;
+	while (++i < table->philo_nbr)
+	{
+		hist_merge(&wait, &table->fork_stats[i].wait);
+		hold += table->fork_stats[i].hold_total;
+	}
+	snprintf(name, sizeof(name), "fork wait (--lock=%s)",
+		table->opt.lock->name);
+	hist_report(name, &wait);
+	if (0 == wait.total)
+		return ;
+	fprintf(stderr, "[metrics] fork hold: avg %.1f us, worst fork %ld "
+		"waited %.1f us, worst fork %ld held %.1f us\n",
+		hold / 1e3 / wait.total, worst(table, false),
+		table->fork_stats[worst(table, false)].wait.max / 1e3,
+		worst(table, true),
+		table->fork_stats[worst(table, true)].hold_max / 1e3);
+}
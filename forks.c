@@ -0,0 +1,62 @@
+#include "philo.h"
+
+/*
+ * ENGINE AGNOSTIC forks & sleep
+ * dinner.c does not care if the philo is a pthread
+ * or a coroutine, it calls these and:
+ * 	~THREAD engine: the --lock of the forks (fork_lock.c)
+ * 		and precise_sleep_until
+ * 	~CORO engine: park / timed yield to the scheduler,
+ * 		the worker thread runs other philos meanwhile
+ *
+ * METRICS=1: every fork counts its waits and holds here
+ * --record / --replay: every grant goes through replay.c
+*/
+void	take_fork(t_philo *philo, t_fork *fork)
+{
+	long	since;
+
+	since = 0;
+	if (METRICS)
+		since = gettime(NANOSECOND);
+	if (philo->coro)
+		coro_take_fork(philo->coro, fork);
+	else
+	{
+		replay_turn(philo, fork);
+		philo->table->opt.lock->lock(philo, fork);
+		replay_granted(philo, fork);
+	}
+	if (METRICS)
+		fork_stats_taken(philo->table, fork, since);
+}
+
+/*
+ * THREAD engine only, --strategy=backoff
+*/
+bool	try_fork(t_philo *philo, t_fork *fork)
+{
+	if (!philo->table->opt.lock->try(philo, fork))
+		return (false);
+	if (METRICS)
+		fork_stats_taken(philo->table, fork, gettime(NANOSECOND));
+	return (true);
+}
+
+void	drop_fork(t_philo *philo, t_fork *fork)
+{
+	if (METRICS)
+		fork_stats_dropped(philo->table, fork);
+	if (philo->coro)
+		coro_drop_fork(philo->coro, fork);
+	else
+		philo->table->opt.lock->unlock(philo, fork);
+}
+
+void	philo_sleep_until(t_philo *philo, long deadline)
+{
+	if (philo->coro)
+		coro_sleep_until(philo->coro, deadline);
+	else
+		precise_sleep_until(deadline, philo->table);
+}
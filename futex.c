@@ -0,0 +1,56 @@
+#include "philo.h"
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+/*
+ * FUTEX, Linux only (LINUX_SRCS in the Makefile)
+ * A 32 bits word everybody can sleep on, and a wake up
+ * that reaches the sleepers in microseconds:
+ * 	~the --lock fork locks park on it (fork_lock.c)
+ * 	~every timed sleep waits on table->end_word, the end
+ * 		of the simulation wakes them all at once
+ * 	~the log writer naps on log->wake between 2 batches
+ *
+ * Any wake up may be spurious, the callers always check again
+*/
+
+/*
+ * Sleep while *word == val
+*/
+void	futex_wait(atomic_uint *word, unsigned int val)
+{
+	syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+/*
+ * Same, but never after deadline, ABSOLUTE CLOCK_MONOTONIC
+ * NANOSECOND like kernel_sleep_until (BITSET takes an absolute
+ * time, the plain WAIT a relative one)
+*/
+void	futex_wait_until(atomic_uint *word, unsigned int val, long deadline)
+{
+	struct timespec	ts;
+
+	ts.tv_sec = deadline / NSEC_PER_SEC;
+	ts.tv_nsec = deadline % NSEC_PER_SEC;
+	syscall(SYS_futex, word, FUTEX_WAIT_BITSET_PRIVATE, val, &ts, NULL,
+		FUTEX_BITSET_MATCH_ANY);
+}
+
+void	futex_wake(atomic_uint *word, int nbr)
+{
+	syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, nbr, NULL, NULL, 0);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+void	cpu_relax(void)
+{
+	__builtin_ia32_pause();
+}
+#else
+
+void	cpu_relax(void)
+{
+}
+#endif
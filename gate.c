@@ -0,0 +1,86 @@
+#include "philo.h"
+
+/*
+ * START GATE
+ * A real rendezvous instead of the old spinlock:
+ * 	~every thread (philos + monitors) arrives and sleeps
+ * 	~the main thread sleeps until the last one arrives
+ * 	~main stamps start_simulation and opens the gate
+ * 		with ONE broadcast, waking everybody together
+ *
+ * 💡 No thread burns CPU while the others are created,
+ * 	even with thousands of philos 💡
+ *
+ * A condvar and not a futex: it runs once per dinner,
+ * the mutex + broadcast costs nothing here and keeps the
+ * check-in count and the open flag under one lock
+*/
+void	gate_init(t_gate *gate, long expected)
+{
+	safe_mutex_handle(&gate->mutex, INIT);
+	safe_cond_handle(&gate->all_arrived, INIT);
+	safe_cond_handle(&gate->opened, INIT);
+	gate->expected = expected;
+	gate->arrived = 0;
+	gate->open = false;
+}
+
+void	gate_destroy(t_gate *gate)
+{
+	safe_mutex_handle(&gate->mutex, DESTROY);
+	safe_cond_handle(&gate->all_arrived, DESTROY);
+	safe_cond_handle(&gate->opened, DESTROY);
+}
+
+/*
+ * Thread side: check in, then sleep until main opens.
+ * --hires: 1 ns timer slack from here, see hires_slack
+*/
+void	wait_all_threads(t_table *table)
+{
+	t_gate	*gate;
+
+	gate = &table->start_gate;
+	safe_mutex_handle(&gate->mutex, LOCK);
+	if (++gate->arrived == gate->expected)
+		safe_cond_handle(&gate->all_arrived, BROADCAST);
+	while (!gate->open)
+		pthread_cond_wait(&gate->opened, &gate->mutex);
+	safe_mutex_handle(&gate->mutex, UNLOCK);
+	hires_slack(table);
+	if (METRICS)
+		metrics_thread_awake(table);
+}
+
+/*
+ * Main side: wait for the last check in,
+ * stamp the start right before the broadcast
+ * and give every philo his first meal time after it.
+ * 🔓 Still under the gate mutex: a woken thread leaves
+ * 	pthread_cond_wait only with the mutex back, so nobody
+ * 	runs before the deadlines are there, and the O(N) loop
+ * 	overlaps the wake ups instead of eating the first t_die 🔓
+*/
+void	gate_open(t_table *table)
+{
+	t_gate	*gate;
+	long	i;
+
+	gate = &table->start_gate;
+	safe_mutex_handle(&gate->mutex, LOCK);
+	while (gate->arrived < gate->expected)
+		pthread_cond_wait(&gate->all_arrived, &gate->mutex);
+	gate->open = true;
+	if (ENGINE_PROCESS == table->opt.engine)
+		process_rendezvous(table);
+	else
+		table->start_simulation = gettime(NANOSECOND);
+	if (METRICS)
+		table->metrics.release = gettime(MICROSECOND);
+	safe_cond_handle(&gate->opened, BROADCAST);
+	i = -1;
+	while (++i < table->philo_nbr)
+		publish_meal(table->philos + i, table->start_simulation);
+	trace_start(table);
+	safe_mutex_handle(&gate->mutex, UNLOCK);
+}
@@ -2,60 +2,54 @@
 
 /*
  * 	SETTERS and GETTERS are very useful to avoid writing
- * 		lots of repetitive code, namely lock🔒 - unlock🔓
+ * 		lots of repetitive code
  *
- * 💡 I decided to use only bools and longs in my structs 
+ * 💡 I decided to use only bools and longs in my structs
  * 		to use a limited nbr of setters & getters 💡
  *
- *  1) if you value type safety and performance and have a 
+ *  1) if you value type safety and performance and have a
  *  		imited number of types, then this approach is excellent.
  *	2) If you value scalability and flexibility, writing all
- *			these setters and getters is not the goto solution 
+ *			these setters and getters is not the goto solution
+ *
+ * 🔓 No more lock - unlock: the shared values are C11 atomics.
+ * 	~setters publish with RELEASE
+ * 	~getters read with ACQUIRE
+ * so everything a thread wrote before a set_* is visible to
+ * the thread that reads the new value with get_*.
+ * Same guarantee of the old mutex pair, without the syscall
+ * and without threads lining up on philo_mutex / table_mutex.
 */
 
 /*
  * Set a bool to value thread safe
 */
-void	set_bool(t_mtx	*mutex, bool *dest, bool value)
+void	set_bool(t_abool *dest, bool value)
 {
-	safe_mutex_handle(mutex, LOCK);
-	*dest = value;
-	safe_mutex_handle(mutex, UNLOCK);
+	atomic_store_explicit(dest, value, memory_order_release);
 }
 
-bool	get_bool(t_mtx *mutex, bool *value)
+bool	get_bool(t_abool *value)
 {
-	bool	ret;
-
-	safe_mutex_handle(mutex, LOCK);
-	ret = *value;
-	safe_mutex_handle(mutex, UNLOCK);
-	return (ret);
+	return (atomic_load_explicit(value, memory_order_acquire));
 }
 
-long	get_long(t_mtx *mutex, long *value)
+long	get_long(t_along *value)
 {
-	long	ret;
-
-	safe_mutex_handle(mutex, LOCK);
-	ret = *value;
-	safe_mutex_handle(mutex, UNLOCK);
-	return (ret);
+	return (atomic_load_explicit(value, memory_order_acquire));
 }
 
-void	set_long(t_mtx *mutex, long *dest, long value)
+void	set_long(t_along *dest, long value)
 {
-	safe_mutex_handle(mutex, LOCK);
-	*dest = value;
-	safe_mutex_handle(mutex, UNLOCK);
+	atomic_store_explicit(dest, value, memory_order_release);
 }
 
 /*
- * I use simulation finished to make 
- * the code more readable, arguably this 
+ * I use simulation finished to make
+ * the code more readable, arguably this
  * function is redundant being just a wrapper.
 */
 bool	simulation_finished(t_table *table)
 {
-	return (get_bool(&table->table_mutex, &table->end_simulation));
+	return (get_bool(&table->end_simulation));
 }
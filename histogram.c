@@ -0,0 +1,67 @@
+#include "philo.h"
+
+/*
+ * LOG-LINEAR HISTOGRAM, METRICS=1
+ *
+ * 	~values < HIST_SUB: one bucket each, exact
+ * 	~bigger: bucket by magnitude (highest bit) and the
+ * 		HIST_SUB_BITS bits right after it
+ *
+ * 💡 Record is a few shifts and an increment, no lock:
+ * 	every histogram has a single writer (a ring producer,
+ * 	the monitor, the log writer). Merged at the report 💡
+*/
+static long	bucket_of(long value)
+{
+	int		magnitude;
+
+	if (value < HIST_SUB)
+		return (value);
+	magnitude = 63 - __builtin_clzl(value) - HIST_SUB_BITS;
+	return ((magnitude + 1) * HIST_SUB + (value >> magnitude) - HIST_SUB);
+}
+
+/*
+ * Lowest value of a bucket, inverse of bucket_of
+*/
+long	hist_value(long bucket)
+{
+	long	magnitude;
+
+	if (bucket < HIST_SUB)
+		return (bucket);
+	magnitude = bucket / HIST_SUB - 1;
+	return ((bucket % HIST_SUB + HIST_SUB) << magnitude);
+}
+
+void	hist_init(t_hist *hist)
+{
+	memset(hist, 0, sizeof(t_hist));
+	hist->min = LONG_MAX;
+}
+
+void	hist_record(t_hist *hist, long value)
+{
+	if (value < 0)
+		value = 0;
+	hist->counts[bucket_of(value)]++;
+	hist->total++;
+	if (value < hist->min)
+		hist->min = value;
+	if (value > hist->max)
+		hist->max = value;
+}
+
+void	hist_merge(t_hist *dst, t_hist *src)
+{
+	long	i;
+
+	i = -1;
+	while (++i < HIST_BUCKETS)
+		dst->counts[i] += src->counts[i];
+	dst->total += src->total;
+	if (src->min < dst->min)
+		dst->min = src->min;
+	if (src->max > dst->max)
+		dst->max = src->max;
+}
@@ -40,14 +40,41 @@ static void	philo_init(t_table *table)
 	{
 		philo = table->philos + i;
 		philo->id = i + 1;
-		philo->full = false;
-		philo->meals_counter = 0;
-		safe_mutex_handle(&philo->philo_mutex, INIT);
+		atomic_init(&philo->full, false);
+		atomic_init(&philo->meals_counter, 0);
+		atomic_init(&philo->last_meal_time, 0);
+		atomic_init(&philo->think_end, 0);
+		philo->think_lead = 0;
+		atomic_init(table->deadlines + i, table->time_to_die);
+		philo->ring = NULL;
+		if (ENGINE_THREAD == table->opt.engine
+			|| ENGINE_PROCESS == table->opt.engine)
+			philo->ring = table->log.rings + i;
+		philo->coro = NULL;
 		philo->table = table;
 		assign_forks(philo, table->forks, i);
 	}
 }
 
+/*
+ * --hires: a spin window longer than a quarter of the
+ * shortest phase would burn the core most of the meal,
+ * and the neighbours share it
+*/
+static void	hires_spin(t_table *table)
+{
+	long	cap;
+
+	if (!table->opt.hires)
+		return ;
+	cap = table->time_to_eat;
+	if (table->time_to_sleep < cap)
+		cap = table->time_to_sleep;
+	cap /= 4;
+	if (table->spin_ns > cap)
+		table->spin_ns = cap;
+}
+
 /*
  * Code to init the table data
  * Controls on errors embedded in 
@@ -63,17 +90,66 @@ void	data_init(t_table *table)
 	int		i;
 
 	i = -1;
-	table->end_simulation = false;
-	table->all_threads_ready = false;
-	table->threads_running_nbr = 0;
-	table->philos = safe_malloc(table->philo_nbr * sizeof(t_philo));
-	table->forks = safe_malloc(table->philo_nbr * sizeof(t_fork));
-	safe_mutex_handle(&table->write_mutex, INIT);
-	safe_mutex_handle(&table->table_mutex, INIT);
+	atomic_init(&table->end_simulation, false);
+	atomic_init(&table->end_word, 0);
+	atomic_init(&table->metrics.last_awake, 0);
+	table->metrics.kill = 0;
+	table->metrics.died_at = 0;
+	table->metrics.shutdown = 0;
+	if (METRICS)
+		hist_init(&table->metrics.death_latency);
+	table->philos = safe_aligned_malloc(table->philo_nbr * sizeof(t_philo));
+	table->forks = safe_aligned_malloc(table->philo_nbr * sizeof(t_fork));
+	table->deadlines = safe_aligned_malloc(table->philo_nbr
+			* sizeof(t_along));
+	table->monitors = NULL;
+	table->monitor_nbr = 0;
+	table->proc.shared = NULL;
+	table->proc.self = -1;
+	if (ENGINE_VIRTUAL != table->opt.engine
+		&& ENGINE_PROCESS != table->opt.engine)
+		monitors_init(table);
+	affinity_init(table);
+	affinity_first_touch(table);
+	log_init(table);
+	trace_init(table);
+	fairness_init(table);
+	fork_stats_init(table);
+	safe_mutex_handle(&table->monitor_mutex, INIT);
+	safe_cond_handle(&table->monitor_cond, INIT);
+	if (table->spin_ns <= 0)
+		calibrate_spin(table);
+	hires_spin(table);
 	while (++i < table->philo_nbr)
 	{
-		safe_mutex_handle(&table->forks[i].fork, INIT);
+		memset(table->forks + i, 0, sizeof(t_fork));
+		if (!strcmp(table->opt.lock->name, "pthread"))
+			safe_mutex_handle(&table->forks[i].fork, INIT);
 		table->forks[i].fork_id = i;
+		table->forks[i].owner = NULL;
+		table->forks[i].waiter = NULL;
 	}
 	philo_init(table);
+	replay_init(table);
+	shm_init(table);
+	if (table->opt.strategy->init)
+		table->opt.strategy->init(table);
+	if (ENGINE_CORO == table->opt.engine)
+	{
+		gate_init(&table->start_gate, table->opt.workers
+			+ table->monitor_nbr);
+		coro_init(table);
+	}
+	else if (ENGINE_VIRTUAL == table->opt.engine)
+	{
+		gate_init(&table->start_gate, 1);
+		virtual_init(table);
+	}
+	else if (ENGINE_PROCESS == table->opt.engine)
+	{
+		gate_init(&table->start_gate, 2);
+		process_init(table);
+	}
+	else
+		gate_init(&table->start_gate, table->philo_nbr + table->monitor_nbr);
 }
@@ -0,0 +1,155 @@
+#include "philo.h"
+
+/*
+ * LIBPHILO, see libphilo.h
+ * The handle owns one table, reinitialized at every run
+ * exactly like ./philo does it once:
+ * 	parse_input, data_init, dinner_start, table_outcome, clean
+ * What survives between 2 runs is what costs:
+ * 	~the threads, parked in the pool (pool.c)
+ * 	~the spin window, calibrated once at create
+ * 	~the options, parsed once
+*/
+
+_Static_assert(PHILO_EV_DIED == (int)DIED, "t_philo_event_kind order");
+_Static_assert(PHILO_EV_TAKE_FIRST_FORK == (int)TAKE_FIRST_FORK,
+	"t_philo_event_kind order");
+_Static_assert(PHILO_DIED == (int)OUTCOME_DIED, "t_philo_outcome order");
+
+/*
+ * The writer thread calls it for every line,
+ * DROP_FORK is a --trace record only
+*/
+static void	lib_sink(void *ctx, t_event *ev, long start)
+{
+	t_philo_table	*t;
+	t_philo_event	out;
+
+	if (ev->status > DIED)
+		return ;
+	t = (t_philo_table *)ctx;
+	out.time_ms = (ev->time - start) / NSEC_PER_MSEC;
+	out.time_us = (ev->time - start) / NSEC_PER_USEC;
+	out.philo_id = ev->philo_id;
+	out.kind = ev->status;
+	out.aux = ev->aux;
+	t->fn(&out, t->ctx);
+}
+
+/*
+ * The checks of main + the ones of a library:
+ * no fork(), no cpu map changed under the caller,
+ * no file of its own: a file that can't be opened
+ * would error_exit on the caller's stdout
+*/
+static int	lib_refuse(t_philo_table *t, int ac, char **av)
+{
+	size_t	len;
+	int		options;
+	int		i;
+
+	options = parse_options(&t->table, ac, av);
+	if (options < 0)
+		return (PHILO_EARGS);
+	t->opt = t->table.opt;
+	if (ENGINE_PROCESS == t->opt.engine || t->opt.batch || t->opt.affinity
+		|| t->opt.shm)
+	{
+		snprintf(t->table.error, ERROR_MAX, "libphilo: no --engine=process, "
+			"--batch, --affinity or --shm");
+		return (PHILO_EARGS);
+	}
+	if (t->opt.trace || t->opt.record || t->opt.replay)
+	{
+		snprintf(t->table.error, ERROR_MAX, "libphilo: no --trace, --record "
+			"or --replay, their file errors exit");
+		return (PHILO_EARGS);
+	}
+	if (ac - options != 5 && ac - options != 6)
+	{
+		snprintf(t->table.error, ERROR_MAX, "libphilo: want philo_nbr t_die "
+			"t_eat t_sleep [meals] after the options");
+		return (PHILO_EARGS);
+	}
+	i = -1;
+	while (++i < ac - options)
+	{
+		len = strlen(av[options + i]) + 1;
+		t->av[i] = memcpy(safe_malloc(len), av[options + i], len);
+	}
+	if (!parse_input(&t->table, t->av))
+		return (PHILO_EARGS);
+	return (PHILO_OK);
+}
+
+/*
+ * 🚨 On PHILO_EARGS *out is still the handle:
+ * 	philo_table_error says why, destroy frees it 🚨
+*/
+int	philo_table_create(t_philo_table **out, int ac, char **av,
+		t_philo_event_fn fn, void *ctx)
+{
+	t_philo_table	*t;
+
+	t = safe_aligned_malloc(sizeof(t_philo_table));
+	memset(t, 0, sizeof(t_philo_table));
+	t->fn = fn;
+	t->ctx = ctx;
+	*out = t;
+	if (lib_refuse(t, ac, av))
+		return (PHILO_EARGS);
+	calibrate_spin(&t->table);
+	t->spin_ns = t->table.spin_ns;
+	return (PHILO_OK);
+}
+
+int	philo_table_run(t_philo_table *t, t_philo_result *res)
+{
+	t_table		*table;
+	t_result	out;
+	long		start;
+
+	if (t->table.error[0])
+		return (PHILO_EARGS);
+	start = gettime(NANOSECOND);
+	table = &t->table;
+	table->opt = t->opt;
+	table->spin_ns = t->spin_ns;
+	table->pool = &t->pool;
+	parse_input(table, t->av);
+	data_init(table);
+	table->log.fd = -1;
+	if (t->fn)
+	{
+		table->log.sink = lib_sink;
+		table->log.sink_ctx = t;
+	}
+	dinner_start(table);
+	table_outcome(table, &out);
+	clean(table);
+	res->outcome = (t_philo_outcome)out.outcome;
+	res->dead_id = out.dead_id;
+	res->died_ms = out.died_ms;
+	res->meals_min = out.meals_min;
+	res->meals_max = out.meals_max;
+	res->wall_ns = gettime(NANOSECOND) - start;
+	return (PHILO_OK);
+}
+
+const char	*philo_table_error(t_philo_table *t)
+{
+	return (t->table.error);
+}
+
+void	philo_table_destroy(t_philo_table *t)
+{
+	long	i;
+
+	if (NULL == t)
+		return ;
+	pool_destroy(&t->pool);
+	i = -1;
+	while (++i < 7)
+		free(t->av[i]);
+	free(t);
+}
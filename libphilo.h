@@ -0,0 +1,100 @@
+#ifndef LIBPHILO_H
+# define LIBPHILO_H
+
+/*
+ * LIBPHILO, the simulator as a library: make lib -> libphilo.a
+ *
+ * 	t_philo_table	*t;
+ * 	t_philo_result	res;
+ * 	char			*av[] = {"sim", "--engine=coro", "5", "800",
+ * 						"200", "200", "7", NULL};
+ *
+ * 	if (philo_table_create(&t, 7, av, on_event, ctx) != PHILO_OK)
+ * 		puts(philo_table_error(t));
+ * 	while (sweeping)
+ * 		philo_table_run(t, &res);
+ * 	philo_table_destroy(t);
+ *
+ * ~av is the argv of ./philo, av[0] included: the same
+ * 	options, the same checks, an error code instead of exit
+ * ~every status line is an event for on_event instead
+ * 	of stdout, called by the writer thread, in order
+ * ~run again and again: the threads stay parked in the
+ * 	pool of the table between 2 runs
+ *
+ * 💡 Only a refused argument is an error code: out of
+ * 	memory or out of threads still exits, like ./philo 💡
+ *
+ * No --engine=process (fork in a library), no --batch,
+ * the loop of runs is the caller's, and no --shm, --trace,
+ * --record or --replay: their file errors would exit.
+ * One table is one dinner at a time, tables don't share
+ * anything: one per thread of the caller is fine
+*/
+
+/*
+ * Return codes
+*/
+# define PHILO_OK		0
+# define PHILO_EARGS	-1
+
+/*
+ * ~kind: same order as t_philo_status
+ * ~aux: fork id / meals counter, the --debug columns
+ * ~time_ms, time_us: since the start of the dinner,
+ * 	time_us for --hires dinners
+*/
+typedef enum e_philo_event_kind
+{
+	PHILO_EV_EATING,
+	PHILO_EV_SLEEPING,
+	PHILO_EV_THINKING,
+	PHILO_EV_TAKE_FIRST_FORK,
+	PHILO_EV_TAKE_SECOND_FORK,
+	PHILO_EV_DIED,
+}			t_philo_event_kind;
+
+typedef struct s_philo_event
+{
+	long				time_ms;
+	long				time_us;
+	int					philo_id;
+	t_philo_event_kind	kind;
+	long				aux;
+}						t_philo_event;
+
+typedef void	(*t_philo_event_fn)(const t_philo_event *ev, void *ctx);
+
+/*
+ * Same order as t_outcome, no ERROR: a run always runs
+*/
+typedef enum e_philo_outcome
+{
+	PHILO_FULL = 1,
+	PHILO_SURVIVED,
+	PHILO_DIED,
+}			t_philo_outcome;
+
+/*
+ * ~dead_id, died_ms: PHILO_DIED only
+ * ~wall_ns: the whole run, real time
+*/
+typedef struct s_philo_result
+{
+	t_philo_outcome	outcome;
+	long			dead_id;
+	long			died_ms;
+	long			meals_min;
+	long			meals_max;
+	long			wall_ns;
+}					t_philo_result;
+
+typedef struct s_philo_table	t_philo_table;
+
+int			philo_table_create(t_philo_table **out, int ac, char **av,
+				t_philo_event_fn fn, void *ctx);
+int			philo_table_run(t_philo_table *t, t_philo_result *res);
+const char	*philo_table_error(t_philo_table *t);
+void		philo_table_destroy(t_philo_table *t);
+
+#endif
@@ -0,0 +1,71 @@
+#include "philo.h"
+
+/*
+ * Merge [lo, mid) and [mid, hi) of src into dst.
+ * <= on the left run keeps the sort STABLE:
+ * events of the same philo never swap.
+*/
+static void	merge(t_event *src, t_event *dst, long bounds[3])
+{
+	long	i;
+	long	j;
+	long	k;
+
+	i = bounds[0];
+	j = bounds[1];
+	k = bounds[0];
+	while (i < bounds[1] && j < bounds[2])
+	{
+		if (src[i].time <= src[j].time)
+			dst[k++] = src[i++];
+		else
+			dst[k++] = src[j++];
+	}
+	while (i < bounds[1])
+		dst[k++] = src[i++];
+	while (j < bounds[2])
+		dst[k++] = src[j++];
+}
+
+static long	min_long(long a, long b)
+{
+	if (a < b)
+		return (a);
+	return (b);
+}
+
+/*
+ * Bottom-up merge sort by timestamp
+ * ~ev:		events to sort
+ * ~tmp:	scratch space, same size
+ * Ping-pong between the 2 arrays, copy back at the end
+*/
+void	sort_events(t_event *ev, t_event *tmp, long n)
+{
+	long	width;
+	long	bounds[3];
+	t_event	*src;
+	t_event	*dst;
+	t_event	*swap;
+
+	src = ev;
+	dst = tmp;
+	width = 1;
+	while (width < n)
+	{
+		bounds[0] = 0;
+		while (bounds[0] < n)
+		{
+			bounds[1] = min_long(bounds[0] + width, n);
+			bounds[2] = min_long(bounds[0] + 2 * width, n);
+			merge(src, dst, bounds);
+			bounds[0] = bounds[2];
+		}
+		swap = src;
+		src = dst;
+		dst = swap;
+		width *= 2;
+	}
+	if (src != ev)
+		memcpy(ev, src, n * sizeof(t_event));
+}
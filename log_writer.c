@@ -0,0 +1,173 @@
+#include "philo.h"
+
+/*
+ * ASYNC LOGGER, consumer side
+ *
+ * The writer thread wakes every LOG_FLUSH_US:
+ * 1) drains all the philo rings into pending
+ * 2) sorts pending by timestamp (stable merge sort,
+ * 		every ring is already sorted)
+ * 3) formats everything older than LOG_GRACE_NS
+ * 4) flushes the batch with one write(2)
+ * 5) --shm: copies the new counters to the stats page (shm.c)
+ *
+ * 💀 When the DIED event is posted, the writer waits for
+ * 	the pushes in flight, drains one last time, writes what
+ * 	happened before the death, then the DIED line: always
+ * 	the last one 💀
+ *
+ * METRICS=1: death latency = DIED line out of write(2)
+ * 	- the true deadline, last meal + time_to_die
+*/
+
+/*
+ * write(2) can write less than asked,
+ * keep going until the batch is out.
+ * No fd (--batch): the lines are dropped.
+ * The VIRTUAL engine has no writer thread and
+ * calls log_emit & log_flush itself
+*/
+void	log_flush(t_log *log)
+{
+	long	done;
+	ssize_t	ret;
+
+	done = 0;
+	while (log->fd >= 0 && done < log->buf_len)
+	{
+		ret = write(log->fd, log->buf + done, log->buf_len - done);
+		if (ret < 0 && EINTR == errno)
+			continue ;
+		if (ret <= 0)
+			break ;
+		done += ret;
+	}
+	log->buf_len = 0;
+}
+
+void	log_emit(t_table *table, t_event *ev)
+{
+	t_log	*log;
+
+	log = &table->log;
+	shm_event(table, ev);
+	if (log->sink)
+	{
+		log->sink(log->sink_ctx, ev, table->start_simulation);
+		return ;
+	}
+	if (log->buf_len > LOG_BUF_SIZE - LOG_LINE_MAX)
+		log_flush(log);
+	log->buf_len += format_event(log->buf + log->buf_len, ev,
+			table->start_simulation, table->opt.stamp_us);
+}
+
+/*
+ * Copy every new event from the rings to pending,
+ * then give the slots back to the philos.
+ * If pending is full what's left stays in the ring
+ * for the next batch
+*/
+static void	drain_rings(t_log *log)
+{
+	long	i;
+	long	head;
+	long	tail;
+	long	max;
+	t_ring	*ring;
+
+	i = -1;
+	max = log->ring_nbr * log->ring_size;
+	while (++i < log->ring_nbr)
+	{
+		ring = log->rings + i;
+		head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+		tail = get_long(&ring->tail);
+		while (head < tail && log->pending_nbr < max)
+			log->pending[log->pending_nbr++]
+				= ring->events[head++ & ring->mask];
+		set_long(&ring->head, head);
+	}
+	sort_events(log->pending, log->tmp, log->pending_nbr);
+}
+
+/*
+ * Format all the pending events with time <= limit,
+ * the younger ones slide to the front for the next batch
+*/
+static void	emit_until(t_table *table, long limit)
+{
+	long	i;
+	t_log	*log;
+
+	log = &table->log;
+	i = 0;
+	while (i < log->pending_nbr && log->pending[i].time <= limit)
+		log_emit(table, log->pending + i++);
+	memmove(log->pending, log->pending + i,
+		(log->pending_nbr - i) * sizeof(t_event));
+	log->pending_nbr -= i;
+}
+
+/*
+ * The death is posted: wait for the producers that passed
+ * their end check before it and did not push yet (see
+ * write_status), their lines are older than the DIED.
+ * Not the PROCESS engine: the children are SIGKILLed before
+ * the post, a ring busy forever is a dead child
+*/
+static void	wait_quiescent(t_table *table)
+{
+	long	i;
+
+	if (ENGINE_PROCESS == table->opt.engine)
+		return ;
+	i = -1;
+	while (++i < table->log.ring_nbr)
+		while (atomic_load(&table->log.rings[i].busy))
+			sched_yield();
+}
+
+/*
+ * Writer thread, lives from the start of the dinner
+ * until the main thread closes the log.
+ * Naps LOG_FLUSH_US on log->wake: the death or the
+ * close wake it up at once, seen taken BEFORE the
+ * check so a bump in between fails the futex wait
+*/
+void	*log_writer(void *data)
+{
+	t_table			*table;
+	t_log			*log;
+	unsigned int	seen;
+
+	table = (t_table *)data;
+	log = &table->log;
+	seen = atomic_load(&log->wake);
+	while (!get_bool(&log->death_posted) && !get_bool(&log->closed))
+	{
+		drain_rings(log);
+		emit_until(table, gettime(NANOSECOND) - LOG_GRACE_NS);
+		log_flush(log);
+		shm_publish(table, false);
+		futex_wait_until(&log->wake, seen, gettime(NANOSECOND)
+			+ LOG_FLUSH_US * NSEC_PER_USEC);
+		seen = atomic_load(&log->wake);
+	}
+	if (get_bool(&log->death_posted))
+		wait_quiescent(table);
+	drain_rings(log);
+	if (get_bool(&log->death_posted))
+	{
+		emit_until(table, log->death.time);
+		log_emit(table, &log->death);
+	}
+	else
+		emit_until(table, LONG_MAX);
+	log_flush(log);
+	shm_publish(table, true);
+	if (METRICS && get_bool(&log->death_posted))
+		hist_record(&table->metrics.death_latency, gettime(NANOSECOND)
+			- log->death.aux);
+	return (NULL);
+}
@@ -0,0 +1,178 @@
+#include "philo.h"
+
+/*
+ * ASYNC LOGGER, producer side
+ *
+ * Every producer thread owns a SPSC ring of fixed size events:
+ * 	~philo (producer) only moves tail
+ * 	~writer (consumer) only moves head
+ * No lock🔓, RELEASE on the index publishes the slot,
+ * ACQUIRE on the other side makes it visible.
+ *
+ * pending can hold every ring full at once, so
+ * the writer can always drain everything.
+ *
+ * ~THREAD engine: 1 ring per philo, LOG_RING_SIZE
+ * ~CORO engine: 1 ring per worker, bigger, a worker
+ * 		pushes for all the philos it runs
+ * ~VIRTUAL engine: no producers, 1 unused ring,
+ * 		only the output buffer is needed
+ * ~PROCESS engine: 1 ring per philo like THREAD, rings and
+ * 		events in shared memory, the children are the producers
+*/
+static void	ring_geometry(t_table *table, long *nbr, long *size)
+{
+	long	per_worker;
+
+	*nbr = table->philo_nbr;
+	*size = LOG_RING_SIZE;
+	if (ENGINE_VIRTUAL == table->opt.engine)
+		*nbr = 1;
+	if (ENGINE_CORO != table->opt.engine)
+		return ;
+	*nbr = table->opt.workers;
+	per_worker = LOG_RING_SIZE * (table->philo_nbr / *nbr + 1);
+	while (*size < per_worker && *size < CORO_RING_MAX)
+		*size *= 2;
+}
+
+/*
+ * PROCESS engine: mapped before the forks,
+ * the parent sees what the children push.
+ * 0 philos, 0 rings: no mapping, mmap of 0 bytes is EINVAL
+*/
+static void	*ring_alloc(t_table *table, size_t bytes)
+{
+	void	*ptr;
+
+	if (ENGINE_PROCESS != table->opt.engine)
+		return (safe_malloc(bytes));
+	if (0 == bytes)
+		return (NULL);
+	ptr = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (MAP_FAILED == ptr)
+		error_exit("mmap of the log rings failed");
+	return (ptr);
+}
+
+static void	ring_free(t_table *table, void *ptr, size_t bytes)
+{
+	if (ENGINE_PROCESS != table->opt.engine)
+		free(ptr);
+	else if (ptr)
+		munmap(ptr, bytes);
+}
+
+void	log_init(t_table *table)
+{
+	long	i;
+	t_log	*log;
+
+	log = &table->log;
+	ring_geometry(table, &log->ring_nbr, &log->ring_size);
+	log->rings = ring_alloc(table, log->ring_nbr * sizeof(t_ring));
+	log->events = ring_alloc(table, log->ring_nbr * log->ring_size
+			* sizeof(t_event));
+	log->pending = safe_malloc(log->ring_nbr * log->ring_size
+			* sizeof(t_event));
+	log->tmp = safe_malloc(log->ring_nbr * log->ring_size
+			* sizeof(t_event));
+	log->buf = safe_malloc(LOG_BUF_SIZE);
+	log->pending_nbr = 0;
+	log->buf_len = 0;
+	log->fd = STDOUT_FILENO;
+	if (table->opt.batch)
+		log->fd = -1;
+	log->sink = NULL;
+	log->sink_ctx = NULL;
+	atomic_init(&log->death_posted, false);
+	atomic_init(&log->closed, false);
+	atomic_init(&log->wake, 0);
+	i = -1;
+	while (++i < log->ring_nbr)
+	{
+		atomic_init(&log->rings[i].head, 0);
+		atomic_init(&log->rings[i].tail, 0);
+		atomic_init(&log->rings[i].busy, 0);
+		log->rings[i].mask = log->ring_size - 1;
+		log->rings[i].events = log->events + i * log->ring_size;
+		log->rings[i].push_wait = NULL;
+		if (METRICS)
+		{
+			log->rings[i].push_wait = safe_malloc(sizeof(t_hist));
+			hist_init(log->rings[i].push_wait);
+		}
+	}
+}
+
+/*
+ * Push an event in the philo ring.
+ * If the ring is full (writer late) wait a bit,
+ * never block after the end of the simulation.
+*/
+void	log_push(t_ring *ring, t_event *ev, t_table *table)
+{
+	long	tail;
+	long	start;
+
+	start = 0;
+	if (METRICS)
+		start = gettime(NANOSECOND);
+	tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	while (tail - get_long(&ring->head) > ring->mask)
+	{
+		if (simulation_finished(table))
+			return ;
+		usleep(LOG_FLUSH_US / 10);
+	}
+	ring->events[tail & ring->mask] = *ev;
+	set_long(&ring->tail, tail + 1);
+	if (METRICS)
+		hist_record(ring->push_wait, gettime(NANOSECOND) - start);
+}
+
+/*
+ * The DIED event does not go in a ring,
+ * it is the last line of the output and
+ * the writer looks for it at every batch.
+ * A PROCESS child hands it to the parent instead
+*/
+void	log_post_death(t_table *table, t_event *ev)
+{
+	if (table->proc.self >= 0)
+	{
+		process_post_death(table, ev);
+		return ;
+	}
+	table->log.death = *ev;
+	set_bool(&table->log.death_posted, true);
+	atomic_fetch_add(&table->log.wake, 1);
+	futex_wake(&table->log.wake, 1);
+}
+
+/*
+ * Main thread: no more events, the writer
+ * flushes the last batch right now
+*/
+void	log_close(t_table *table)
+{
+	set_bool(&table->log.closed, true);
+	atomic_fetch_add(&table->log.wake, 1);
+	futex_wake(&table->log.wake, 1);
+}
+
+void	log_destroy(t_table *table)
+{
+	long	i;
+
+	i = -1;
+	while (++i < table->log.ring_nbr)
+		free(table->log.rings[i].push_wait);
+	ring_free(table, table->log.rings, table->log.ring_nbr * sizeof(t_ring));
+	ring_free(table, table->log.events, table->log.ring_nbr
+		* table->log.ring_size * sizeof(t_event));
+	free(table->log.pending);
+	free(table->log.tmp);
+	free(table->log.buf);
+}
@@ -3,15 +3,30 @@
 /*
  * INPUT
  *
- * ./philo 5 800 200 200 [7]
+ * ./philo [--options] 5 800 200 200 [7]
+ * options are skipped, av[1] is always the philos nbr
+ *
+ * ./philo [--options] --batch=file
+ * no classic arguments, one table per line, see batch.c
 */
 int	main(int ac, char **av)
 {
 	t_table	table;
+	int		options;
 
-	if (5 == ac || 6 == ac)
+	options = parse_options(&table, ac, av);
+	if (options < 0)
+		error_exit(table.error);
+	table.spin_ns = 0;
+	table.pool = NULL;
+	ac -= options;
+	av += options;
+	if (table.opt.batch && 1 == ac)
+		return (batch_run(&table.opt));
+	if (NULL == table.opt.batch && (5 == ac || 6 == ac))
 	{
-		parse_input(&table, av);
+		if (!parse_input(&table, av))
+			error_exit(table.error);
 		data_init(&table);
 		dinner_start(&table);
 		clean(&table);
@@ -19,7 +34,8 @@ int	main(int ac, char **av)
 	else
 	{
 		error_exit("Wrong input:\n"
-			G"✅ ./philo 5 800 200 200 [7] ✅\n"
-			"         t_die t_eat t_sleep [meals_limit]"RST);
+			G"✅ ./philo [--options] 5 800 200 200 [7] ✅\n"
+			"         t_die t_eat t_sleep [meals_limit]\n"
+			"✅ ./philo [--options] --batch=file ✅"RST);
 	}
 }
@@ -0,0 +1,126 @@
+#include "philo.h"
+
+/*
+ * METRICS
+ * Compiled in only with ~make METRICS=1
+ * All the calls are behind if (METRICS), with METRICS 0
+ * the compiler removes them: zero cost.
+ *
+ * The report goes to stderr, stdout stays the
+ * exact same simulation log.
+*/
+
+/*
+ * Every thread leaving the start gate records the time,
+ * we keep the latest one: how long the single broadcast
+ * took to wake everybody up
+*/
+void	metrics_thread_awake(t_table *table)
+{
+	long	now;
+	long	last;
+
+	now = gettime(MICROSECOND);
+	last = get_long(&table->metrics.last_awake);
+	while (now > last
+		&& !atomic_compare_exchange_weak(&table->metrics.last_awake,
+			&last, now))
+		;
+}
+
+/*
+ * Death claimed -> every thread (or child) joined:
+ * the sleepers are woken by the end_word futex,
+ * nobody finishes his t_eat / t_sleep first
+*/
+static void	shutdown_report(t_metrics *m)
+{
+	if (m->died_at)
+		fprintf(stderr, "[metrics] shutdown: death -> every thread "
+			"joined %.1f us\n", m->shutdown / 1e3);
+}
+
+/*
+ * STARTUP
+ * ~create -> release: threads creation + rendezvous
+ * ~release -> last awake: wake up spread of the broadcast
+ * The VIRTUAL engine has no threads to measure,
+ * only the fairness report.
+ * The PROCESS engine counters live in the children,
+ * the parent reports the kill and the death latency
+*/
+void	metrics_report(t_table *table)
+{
+	t_metrics	*m;
+	t_hist		push_wait;
+	long		i;
+
+	m = &table->metrics;
+	if (ENGINE_PROCESS == table->opt.engine)
+	{
+		if (m->kill)
+			fprintf(stderr, "[metrics] process: SIGKILL sent %ld us "
+				"after the death\n", m->kill / NSEC_PER_USEC);
+		hist_report("death latency", &m->death_latency);
+		shutdown_report(m);
+		return ;
+	}
+	fairness_report(table);
+	if (ENGINE_VIRTUAL == table->opt.engine)
+		return ;
+	fork_stats_report(table);
+	fprintf(stderr, "[metrics] startup: %ld threads, create->release "
+		"%ld us, release->last awake %ld us\n",
+		table->start_gate.expected, m->release - m->create,
+		get_long(&m->last_awake) - m->release);
+	hist_report("death latency", &m->death_latency);
+	shutdown_report(m);
+	monitors_report(table);
+	affinity_report(table);
+	hist_init(&push_wait);
+	i = -1;
+	while (++i < table->log.ring_nbr)
+		hist_merge(&push_wait, table->log.rings[i].push_wait);
+	hist_report("log push wait", &push_wait);
+}
+
+/*
+ * Smallest bucket value with at least p per mille
+ * of the samples at or below it
+*/
+static long	percentile(t_hist *hist, long per_mille)
+{
+	long	i;
+	long	seen;
+	long	target;
+
+	target = (hist->total * per_mille + 999) / 1000;
+	seen = 0;
+	i = -1;
+	while (++i < HIST_BUCKETS)
+	{
+		seen += hist->counts[i];
+		if (seen >= target && seen && hist_value(i) < hist->min)
+			return (hist->min);
+		if (seen >= target && seen)
+			return (hist_value(i));
+	}
+	return (hist->max);
+}
+
+/*
+ * One line per histogram, MICROSECOND
+*/
+void	hist_report(const char *name, t_hist *hist)
+{
+	if (0 == hist->total)
+	{
+		fprintf(stderr, "[metrics] %s: no samples\n", name);
+		return ;
+	}
+	fprintf(stderr, "[metrics] %s: n=%ld min=%.1f p50=%.1f p90=%.1f "
+		"p99=%.1f p99.9=%.1f max=%.1f us\n", name, hist->total,
+		hist->min / 1e3, percentile(hist, 500) / 1e3,
+		percentile(hist, 900) / 1e3, percentile(hist, 990) / 1e3,
+		percentile(hist, 999) / 1e3, hist->max / 1e3);
+}
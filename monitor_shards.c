@@ -0,0 +1,107 @@
+#include "philo.h"
+
+/*
+ * SHARDED MONITORS
+ * One heap for 100k philos means one thread doing every
+ * lazy re-key of every meal. With K monitors:
+ * 	~monitor i owns the contiguous slice [lo, hi) of the philos
+ * 		(and of the SoA table->deadlines, no false sharing
+ * 		between monitors but at the slice borders)
+ * 	~every heap is N/K big, every monitor wakes only
+ * 		for its own deadlines
+ * 	~the first death wins, see claim_death: exactly one DIED
+ *
+ * 💡 K defaults to one monitor every MONITOR_SLICE philos,
+ * 	never more than the cores. --monitors=K forces it 💡
+*/
+
+/*
+ * --monitors=K, or the default, in [1, philo_nbr]
+*/
+static long	monitor_count(t_table *table)
+{
+	long	cores;
+	long	k;
+
+	k = table->opt.monitors;
+	if (0 == k)
+	{
+		cores = sysconf(_SC_NPROCESSORS_ONLN);
+		k = (table->philo_nbr + MONITOR_SLICE - 1) / MONITOR_SLICE;
+		if (k > cores)
+			k = cores;
+	}
+	if (k > table->philo_nbr)
+		k = table->philo_nbr;
+	if (k < 1)
+		k = 1;
+	return (k);
+}
+
+/*
+ * Split the philos in monitor_nbr slices,
+ * the first philo_nbr % K slices get one philo more
+*/
+void	monitors_init(t_table *table)
+{
+	t_monitor	*mon;
+	long		i;
+	long		size;
+	long		extra;
+
+	table->monitor_nbr = monitor_count(table);
+	table->monitors = safe_aligned_malloc(table->monitor_nbr
+			* sizeof(t_monitor));
+	size = table->philo_nbr / table->monitor_nbr;
+	extra = table->philo_nbr % table->monitor_nbr;
+	i = -1;
+	while (++i < table->monitor_nbr)
+	{
+		mon = table->monitors + i;
+		mon->id = i;
+		mon->table = table;
+		mon->lo = i * size + i;
+		if (i >= extra)
+			mon->lo = i * size + extra;
+		mon->hi = mon->lo + size + (i < extra);
+		if (METRICS)
+			hist_init(&mon->period);
+	}
+}
+
+void	monitors_start(t_table *table)
+{
+	long	i;
+
+	i = -1;
+	while (++i < table->monitor_nbr)
+		dinner_thread_handle(table, &table->monitors[i].thread,
+			monitor_dinner, table->monitors + i, CREATE);
+}
+
+void	monitors_join(t_table *table)
+{
+	long	i;
+
+	i = -1;
+	while (++i < table->monitor_nbr)
+		dinner_thread_handle(table, &table->monitors[i].thread,
+			NULL, NULL, JOIN);
+}
+
+/*
+ * METRICS=1: the periods of all the monitors in one line
+*/
+void	monitors_report(t_table *table)
+{
+	t_hist	period;
+	long	i;
+
+	hist_init(&period);
+	i = -1;
+	while (++i < table->monitor_nbr)
+		hist_merge(&period, &table->monitors[i].period);
+	fprintf(stderr, "[metrics] monitors: %ld, about %ld philos each\n",
+		table->monitor_nbr, table->philo_nbr / table->monitor_nbr);
+	hist_report("monitor period", &period);
+}
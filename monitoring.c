@@ -1,64 +1,179 @@
 #include "philo.h"
-#include <stdio.h>
 
 /*
- * 1) Check if the philo is full,
- * 	he has already finished
- * 	his own simulation. Monitor 
- * 	does not care. Return.
+ * Absolute time (NANOSECOND) at which the philo
+ * is dead if he does not eat again.
+ * The philo dies when elapsed > time_to_die,
+ * so the first "dead" nanosecond is last + time_to_die + 1
  *
- * 2) Check if the philo is died
- * reading in a thread safe manner
- * the last_meal 
+ * 💡 Read from the SoA table->deadlines, not from the philo:
+ * 	LONG_MAX means full 💡
+*/
+static long	death_deadline(t_table *table, long idx)
+{
+	long	deadline;
+
+	deadline = get_long(table->deadlines + idx);
+	if (LONG_MAX == deadline)
+		return (LONG_MAX);
+	return (deadline + 1);
+}
+
+/*
+ * --duration: the dinner stops there, nobody died
+*/
+static long	horizon(t_table *table)
+{
+	if (LONG_MAX == table->opt.duration)
+		return (LONG_MAX);
+	return (table->start_simulation + table->opt.duration);
+}
+
+/*
+ * Sleep until the absolute deadline (the horizon at most),
+ * stop_simulation() wakes me up earlier.
+ * monitor_cond runs on CLOCK_MONOTONIC, see safe_cond_handle
  *
- * 🚨 time_to_die / 1e3 🚨
- * I need to convert back from micro to milli
- * t_to_die
+ * --hires: the death must be seen in microseconds, not
+ * 	in the 10 ms of the subject. Same policy of the philos:
+ * 	wake up spin_ns early, spin the rest
+*/
+static void	monitor_sleep(t_table *table, long deadline)
+{
+	struct timespec	ts;
+	long			wake;
+
+	if (deadline > horizon(table))
+		deadline = horizon(table);
+	wake = deadline;
+	if (table->opt.hires)
+		wake = deadline - table->spin_ns;
+	ts.tv_sec = wake / NSEC_PER_SEC;
+	ts.tv_nsec = wake % NSEC_PER_SEC;
+	safe_mutex_handle(&table->monitor_mutex, LOCK);
+	if (!simulation_finished(table) && wake > gettime(NANOSECOND))
+		pthread_cond_timedwait(&table->monitor_cond, &table->monitor_mutex,
+			&ts);
+	safe_mutex_handle(&table->monitor_mutex, UNLOCK);
+	while (table->opt.hires && gettime(NANOSECOND) < deadline
+		&& !simulation_finished(table))
+		cpu_relax();
+}
+
+/*
+ * Look at the philo with the earliest deadline
+ * 1) Check if the philo is full,
+ * 	he has already finished
+ * 	his own simulation. Monitor
+ * 	does not care. Out of the heap.
+ * 2) He ate in the meantime: deadline only moves
+ * 	forward, update the key and let it sink
+ * 3) Deadline still the same and passed: died,
+ * 	--replay: if the recording says so, see replay.c
+ * 	*deadline keeps the one checked, the DIED line has it
 */
-static bool	philo_died(t_philo *philo)
+static bool	philo_died(t_table *table, t_heap *heap, long *deadline_out)
 {
-	long	elapsed;
-	long	t_to_die;
+	long	deadline;
 
-	if (get_bool(&philo->philo_mutex, &philo->full))
+	deadline = death_deadline(table, heap->nodes[0].philo_idx);
+	*deadline_out = deadline - 1;
+	if (LONG_MAX == deadline)
+	{
+		heap_pop(heap);
+		return (false);
+	}
+	if (deadline > heap->nodes[0].when)
+	{
+		heap_update_top(heap, deadline);
+		return (false);
+	}
+	if (!replay_death_ok(table, heap->nodes[0].philo_idx))
+	{
+		heap_update_top(heap, gettime(NANOSECOND) + REPLAY_RECHECK_NS);
 		return (false);
-	elapsed = gettime(MILLISECOND) - get_long(&philo->philo_mutex,
-			&philo->last_meal_time);
-	t_to_die = philo->table->time_to_die / 1e3;
-	if (elapsed > t_to_die)
-		return (true);
-	return (false);
+	}
+	return (true);
+}
+
+/*
+ * Fill the heap with the first deadline of every philo
+ * of my slice, the heap only knows [lo, hi)
+*/
+static void	heap_init(t_monitor *mon, t_heap *heap)
+{
+	long	i;
+
+	heap->nodes = safe_malloc((mon->hi - mon->lo) * sizeof(t_deadline));
+	heap->size = 0;
+	i = mon->lo - 1;
+	while (++i < mon->hi)
+		heap_push(heap, death_deadline(mon->table, i), i);
+}
+
+/*
+ * METRICS=1: period between 2 loops of the monitor,
+ * ~ the time it sleeps between 2 deadlines
+*/
+static long	monitor_tick(t_monitor *mon, long last_wake)
+{
+	long	now;
+
+	now = gettime(NANOSECOND);
+	if (last_wake)
+		hist_record(&mon->period, now - last_wake);
+	return (now);
 }
 
 /*
- * THREAD continuosly monitoring death philos
- * Two conditions to finish
+ * THREAD monitoring death philos, DEADLINE DRIVEN
+ * No more busy scan 🔥 the monitor sleeps until the
+ * earliest deadline in the heap, then checks only that philo.
+ *
+ * 💡 Eating only pushes a deadline forward, so the monitor
+ * 	never needs to wake earlier than the heap top: the stale
+ * 	key is fixed lazily when it expires 💡
+ *
+ * With many philos there are table->monitor_nbr of us,
+ * each one with the heap of its own slice (monitor_shards.c)
  *
- * 1) if philo is death, set the flag end simulation to true and return
+ * Three conditions to finish
+ * 1) if philo is death, claim the death: the first monitor
+ * 		turning end_simulation ON writes DIED, and return
  * 2) All philos are full, end_simulation will be turned on by the main
  * 		thread in this case, when all the philos are JOINED
- * 	💡end_simulation is changed by the main thread | monitor💡
+ * 3) --duration reached, the monitor stops the dinner
+ * 	💡end_simulation is changed by the main thread | monitors💡
 */
 void	*monitor_dinner(void *data)
 {
-	int			i;
+	t_monitor	*mon;
 	t_table		*table;
+	t_heap		heap;
+	long		last_wake;
+	long		deadline;
 
-	table = (t_table *)data;
-	while (!all_threads_running(&table->table_mutex,
-			&table->threads_running_nbr, table->philo_nbr))
-		;
+	mon = (t_monitor *)data;
+	table = mon->table;
+	wait_all_threads(table);
+	heap_init(mon, &heap);
+	last_wake = 0;
 	while (!simulation_finished(table))
-	{	
-		i = -1;
-		while (++i < table->philo_nbr && !simulation_finished(table))
+	{
+		if (METRICS)
+			last_wake = monitor_tick(mon, last_wake);
+		if (gettime(NANOSECOND) >= horizon(table))
+			stop_simulation(table);
+		else if (0 == heap.size)
+			monitor_sleep(table, gettime(NANOSECOND) + NSEC_PER_SEC);
+		else if (gettime(NANOSECOND) < heap.nodes[0].when)
+			monitor_sleep(table, heap.nodes[0].when);
+		else if (philo_died(table, &heap, &deadline) && claim_death(table))
 		{
-			if (philo_died(table->philos + i))
-			{
-				set_bool(&table->table_mutex, &table->end_simulation, true);
-				write_status(DIED, table->philos + i, DEBUG_MODE);
-			}
+			write_death(table->philos + heap.nodes[0].philo_idx, deadline);
+			replay_death(table, heap.nodes[0].philo_idx);
 		}
 	}
+	free(heap.nodes);
 	return (NULL);
 }
@@ -0,0 +1,249 @@
+#include "philo.h"
+
+/*
+ * OPTIONS
+ * Optional --flags go BEFORE the classic arguments:
+ *
+ * ./philo --engine=coro --workers=4 100000 800 200 200 [7]
+ *
+ * 	~--engine=thread	one pthread per philo (default)
+ * 	~--engine=coro		philos as coroutines on worker threads
+ * 	~--engine=process	one forked process per philo, see process.c
+ * 	~--workers=N		CORO engine threads, default 1 per core
+ * 	~--virtual-time		discrete-event simulation, no real clock
+ * 	~--seed=N			VIRTUAL tie breaks, same seed same output
+ * 	~--duration=ms		horizon, default until death or full
+ * 						(BATCH_DURATION_MS in --batch)
+ * 	~--quiet			VIRTUAL, print only the death
+ * 	~--strategy=name	hierarchy|waiter|chandy|backoff, see strategy.c
+ * 	~--monitors=K		monitor threads, default from cores and philos
+ * 	~--affinity		pin philos, forks and monitors, see affinity.c
+ * 	~--trace=file		binary event trace, see trace.c
+ * 	~--think=adaptive	think time from the rotation, default fixed (think.c)
+ * 	~--lock=name		pthread|ticket|mcs|hybrid fork locks, see fork_lock.c
+ * 	~--batch=file		one scenario per line, many tables at once (batch.c)
+ * 	~--jobs=N			tables running at once in --batch, default cores
+ * 	~--hires			t_die t_eat t_sleep in microseconds, 100 us min
+ * 	~--stamp=us		timestamps with 3 decimals, 12.345 (ms by default)
+ * 	~--record=file		order of the fork grants + the death, see replay.c
+ * 	~--replay=file		the same grants in the same order
+ * 	~--shm=name		live stats page for tools/philo_top, see shm.c
+*/
+
+/*
+ * "--workers=12" with "--workers=" -> "12"
+ * NULL if the flag is another one
+*/
+static const char	*flag_value(const char *arg, const char *flag)
+{
+	size_t	len;
+
+	len = strlen(flag);
+	if (strncmp(arg, flag, len))
+		return (NULL);
+	return (arg + len);
+}
+
+/*
+ * No exit in here either: the first error stays in
+ * table->error, parse_options returns -1 at the end.
+ * main exits with it, libphilo returns PHILO_EARGS
+*/
+static void	opt_error(t_table *table, const char *error)
+{
+	if ('\0' == table->error[0])
+		snprintf(table->error, ERROR_MAX, "%s", error);
+}
+
+static long	parse_count(t_table *table, const char *value)
+{
+	long	nbr;
+	char	*end;
+
+	nbr = strtol(value, &end, 10);
+	if (*end || nbr < 1 || nbr > INT_MAX)
+	{
+		opt_error(table, "Option values are positive integers");
+		return (1);
+	}
+	return (nbr);
+}
+
+static void	parse_engine(t_table *table, const char *value)
+{
+	if (!strcmp(value, "thread"))
+		table->opt.engine = ENGINE_THREAD;
+	else if (!strcmp(value, "coro"))
+		table->opt.engine = ENGINE_CORO;
+	else if (!strcmp(value, "process"))
+		table->opt.engine = ENGINE_PROCESS;
+	else
+		opt_error(table, "--engine=thread|coro|process");
+}
+
+static void	parse_think(t_table *table, const char *value)
+{
+	if (!strcmp(value, "fixed"))
+		table->opt.think = THINK_FIXED;
+	else if (!strcmp(value, "adaptive"))
+		table->opt.think = THINK_ADAPTIVE;
+	else
+		opt_error(table, "--think=fixed|adaptive");
+}
+
+/*
+ * --strategy= / --lock=: an unknown name is an error,
+ * the default stays until parse_options returns -1
+*/
+static void	parse_table(t_table *table, const char *arg)
+{
+	const t_strategy	*strategy;
+	const t_fork_lock	*lock;
+
+	if (flag_value(arg, "--strategy="))
+	{
+		strategy = strategy_find(flag_value(arg, "--strategy="));
+		if (NULL == strategy)
+			opt_error(table,
+				"--strategy=hierarchy|waiter|chandy|backoff|semaphore");
+		else
+			table->opt.strategy = strategy;
+		return ;
+	}
+	lock = lock_find(flag_value(arg, "--lock="));
+	if (NULL == lock)
+		opt_error(table, "--lock=pthread|ticket|mcs|hybrid");
+	else
+		table->opt.lock = lock;
+}
+
+static void	parse_one(t_table *table, const char *arg)
+{
+	if (flag_value(arg, "--engine="))
+		parse_engine(table, flag_value(arg, "--engine="));
+	else if (flag_value(arg, "--workers="))
+		table->opt.workers = parse_count(table, flag_value(arg, "--workers="));
+	else if (!strcmp(arg, "--virtual-time"))
+		table->opt.engine = ENGINE_VIRTUAL;
+	else if (flag_value(arg, "--seed="))
+		table->opt.seed = parse_count(table, flag_value(arg, "--seed="));
+	else if (flag_value(arg, "--duration="))
+		table->opt.duration = parse_count(table, flag_value(arg, "--duration="))
+			* NSEC_PER_MSEC;
+	else if (!strcmp(arg, "--quiet"))
+		table->opt.quiet = true;
+	else if (flag_value(arg, "--strategy=") || flag_value(arg, "--lock="))
+		parse_table(table, arg);
+	else if (flag_value(arg, "--monitors="))
+		table->opt.monitors = parse_count(table, flag_value(arg, "--monitors="));
+	else if (!strcmp(arg, "--affinity"))
+		table->opt.affinity = true;
+	else if (flag_value(arg, "--trace="))
+		table->opt.trace = flag_value(arg, "--trace=");
+	else if (flag_value(arg, "--think="))
+		parse_think(table, flag_value(arg, "--think="));
+	else if (flag_value(arg, "--batch="))
+		table->opt.batch = flag_value(arg, "--batch=");
+	else if (flag_value(arg, "--jobs="))
+		table->opt.jobs = parse_count(table, flag_value(arg, "--jobs="));
+	else if (!strcmp(arg, "--hires"))
+		table->opt.hires = true;
+	else if (!strcmp(arg, "--stamp=us") || !strcmp(arg, "--stamp=ms"))
+		table->opt.stamp_us = !strcmp(arg, "--stamp=us");
+	else if (flag_value(arg, "--record="))
+		table->opt.record = flag_value(arg, "--record=");
+	else if (flag_value(arg, "--replay="))
+		table->opt.replay = flag_value(arg, "--replay=");
+	else if (flag_value(arg, "--shm="))
+		table->opt.shm = flag_value(arg, "--shm=");
+	else
+		opt_error(table, "Unknown option");
+}
+
+/*
+ * --batch runs many tables in ONE process:
+ * 	~no --engine=process, the children are forked per table
+ * 	~no --trace, --affinity or --shm, one file, one cpu
+ * 		map and one stats page for the whole process
+ * 	~every table ends, --duration or BATCH_DURATION_MS
+*/
+static void	check_batch(t_table *table, t_options *opt)
+{
+	if (NULL == opt->batch)
+		return ;
+	if (ENGINE_PROCESS == opt->engine)
+		opt_error(table, "--batch runs the tables in one process, "
+			"not with --engine=process");
+	if (opt->trace || opt->affinity || opt->shm)
+		opt_error(table, "--trace, --affinity and --shm are for one table, "
+			"not --batch");
+	if (LONG_MAX == opt->duration)
+		opt->duration = BATCH_DURATION_MS * NSEC_PER_MSEC;
+}
+
+/*
+ * --record / --replay: the grants of the THREAD engine forks,
+ * one table. The waiter seats and the backoff try-locks
+ * decide outside the grants, chandy has no lock
+*/
+static void	check_replay(t_table *table, t_options *opt)
+{
+	if (NULL == opt->record && NULL == opt->replay)
+		return ;
+	if (opt->record && opt->replay)
+		opt_error(table, "--record or --replay, not both");
+	else if (ENGINE_THREAD != opt->engine || opt->batch)
+		opt_error(table, "--record / --replay: --engine=thread, no --batch");
+	else if (strcmp(opt->strategy->name, "hierarchy"))
+		opt_error(table, "--record / --replay: --strategy=hierarchy only");
+}
+
+/*
+ * Fill table->opt, defaults first.
+ * Returns how many argv entries were options,
+ * main skips them before the classic parsing.
+ * -1 and table->error if refused
+*/
+int	parse_options(t_table *table, int ac, char **av)
+{
+	int	i;
+
+	memset(&table->opt, 0, sizeof(t_options));
+	table->error[0] = '\0';
+	table->opt.engine = ENGINE_THREAD;
+	table->opt.seed = 1;
+	table->opt.duration = LONG_MAX;
+	table->opt.strategy = NULL;
+	table->opt.lock = lock_find("pthread");
+	table->opt.workers = sysconf(_SC_NPROCESSORS_ONLN);
+	if (table->opt.workers < 1)
+		table->opt.workers = 1;
+	table->opt.jobs = table->opt.workers;
+	i = 1;
+	while (i < ac && !strncmp(av[i], "--", 2))
+		parse_one(table, av[i++]);
+	check_batch(table, &table->opt);
+	if (NULL == table->opt.strategy && ENGINE_PROCESS == table->opt.engine)
+		table->opt.strategy = strategy_find("semaphore");
+	else if (NULL == table->opt.strategy)
+		table->opt.strategy = strategy_find("hierarchy");
+	if ((ENGINE_PROCESS == table->opt.engine)
+		!= !strcmp(table->opt.strategy->name, "semaphore"))
+		opt_error(table, "--strategy=semaphore is the --engine=process one");
+	if (ENGINE_THREAD != table->opt.engine && ENGINE_PROCESS
+		!= table->opt.engine && strcmp(table->opt.strategy->name, "hierarchy"))
+		opt_error(table,
+			"Only --strategy=hierarchy runs outside --engine=thread");
+	if (ENGINE_PROCESS == table->opt.engine
+		&& THINK_ADAPTIVE == table->opt.think)
+		opt_error(table,
+			"--think=adaptive reads the neighbours, not across processes");
+	if (strcmp(table->opt.lock->name, "pthread")
+		&& (ENGINE_THREAD != table->opt.engine
+			|| !strcmp(table->opt.strategy->name, "chandy")))
+		opt_error(table, "--lock is for the --engine=thread forks, not chandy");
+	check_replay(table, &table->opt);
+	if (table->error[0])
+		return (-1);
+	return (i - 1);
+}
@@ -15,6 +15,18 @@ static inline bool	is_digit(char c)
 	return (c >= '0' && c <= '9');
 }
 
+/*
+ * The table keeps the error, the caller decides:
+ * main exits with it, a --batch scenario reports it
+ * and the other tables keep going.
+ * NULL to return it straight from valid_input
+*/
+static void	*refuse(t_table *table, const char *error)
+{
+	snprintf(table->error, ERROR_MAX, "%s", error);
+	return (NULL);
+}
+
 /*
  * 1) Check for negatives
  * 2) Check if the number is legit 
@@ -24,10 +36,11 @@ static inline bool	is_digit(char c)
  * this will be useful for 12093838384775929283947592283948586
  * these crazy inputs. In atol i will refine the check
  *
- * Return a pointer to the actual number for atol
+ * Return a pointer to the actual number for atol,
+ * NULL if refused
  * 
 */
-static const char	*valid_input(const char *str)
+static const char	*valid_input(t_table *table, const char *str)
 {
 	int			len;
 	const char	*number;
@@ -38,14 +51,14 @@ static const char	*valid_input(const char *str)
 	if (*str == '+')
 		++str;
 	else if (*str == '-')
-		error_exit("Feed me only positive values");
+		return (refuse(table, "Feed me only positive values"));
 	if (!is_digit(*str))
-		error_exit("The input is not a correct digit");
+		return (refuse(table, "The input is not a correct digit"));
 	number = str;
 	while (is_digit(*str++))
 		++len;
 	if (len > 10)
-		error_exit("The value is too big, INT_MAX is the limit");
+		return (refuse(table, "The value is too big, INT_MAX is the limit"));
 	return (number);
 }
 
@@ -57,27 +70,34 @@ static const char	*valid_input(const char *str)
  * The check for INT_MAX here is 
  * for numbers in range:
  * (2_147_483_648 <-> 9_999_999_999)
+ *
+ * -1 if refused, the inputs are never negative
 */
-static long	ft_atol(const char *str)
+static long	ft_atol(t_table *table, const char *str)
 {
 	long	num;
 
 	num = 0;
-	str = valid_input(str);
+	str = valid_input(table, str);
+	if (NULL == str)
+		return (-1);
 	while (is_digit(*str))
 		num = (num * 10) + (*str++ - '0');
 	if (num > INT_MAX)
-		error_exit("INT_MAX is the limit, not the sky");
+	{
+		refuse(table, "INT_MAX is the limit, not the sky");
+		return (-1);
+	}
 	return (num);
 }
 
 /*
  * 🚨 times in milliseconds 🚨
- * for the usleep function we need micro
- * so i immediately convert
- *  i use handy scientific notation 
- *  ~1e3 = 1_000
- *  ~1e6 = 1_000_000
+ * the time engine works in NANOSECOND
+ * so i immediately convert, integer math
+ *  ~NSEC_PER_MSEC = 1_000_000
+ * --hires: in microseconds, NSEC_PER_USEC, and
+ * 	HIRES_MIN_NS (100 us) instead of 60 ms
  *
  * INPUT 
  * [0] ./philo
@@ -87,31 +107,77 @@ static long	ft_atol(const char *str)
  * [4] time_to_sleep
  * [5] [number_of_times_each_philosopher_must_eat]
  *
- * Check for max 200 philos
+ * Check for max 200 philos, threads or processes
+ * (CORO_PHILO_MAX for coro & virtual)
  * and timestamps > 60ms
  *
  * nbr_limit_meals -1 acts as a flag:
  * 	NO LIMITS
+ *
+ * 💡 No exit in here: false and table->error,
+ * 	one bad scenario of a --batch must not kill the others 💡
 */
-void	parse_input(t_table *table, char **av)
+static bool	parse_times(t_table *table, char **av)
 {
-	table->philo_nbr = ft_atol(av[1]);
-	if (table->philo_nbr > PHILO_MAX)
+	long	value[3];
+	long	unit;
+	long	min;
+	int		i;
+
+	i = -1;
+	while (++i < 3)
+	{
+		value[i] = ft_atol(table, av[2 + i]);
+		if (value[i] < 0)
+			return (false);
+	}
+	unit = NSEC_PER_MSEC;
+	min = 60 * NSEC_PER_MSEC;
+	if (table->opt.hires)
+		unit = NSEC_PER_USEC;
+	if (table->opt.hires)
+		min = HIRES_MIN_NS;
+	table->time_to_die = value[0] * unit;
+	table->time_to_eat = value[1] * unit;
+	table->time_to_sleep = value[2] * unit;
+	if (table->time_to_die < min || table->time_to_sleep < min
+		|| table->time_to_eat < min)
+	{
+		if (table->opt.hires)
+			refuse(table, "--hires: use timestamps of 100us or more");
+		else
+			refuse(table, "Use timestamps major than 60ms");
+		return (false);
+	}
+	return (true);
+}
+
+bool	parse_input(t_table *table, char **av)
+{
+	table->philo_nbr = ft_atol(table, av[1]);
+	if (table->philo_nbr < 0)
+		return (false);
+	if (ENGINE_THREAD != table->opt.engine
+		&& ENGINE_PROCESS != table->opt.engine)
+	{
+		if (table->philo_nbr > CORO_PHILO_MAX)
+		{
+			refuse(table, "Too many philos for this engine");
+			return (false);
+		}
+	}
+	else if (table->philo_nbr > PHILO_MAX)
 	{
-		printf(RED"Max philos are %d\n"
-			G"make fclean and re-make with PHILO_MAX=nbr to change it\n"RST,
+		snprintf(table->error, ERROR_MAX, "Max philos are %d\n"G
+			"make fclean and re-make with PHILO_MAX=nbr to change it"RST,
 			PHILO_MAX);
-		exit(EXIT_FAILURE);
+		return (false);
 	}
-	table->time_to_die = ft_atol(av[2]) * 1e3;
-	table->time_to_eat = ft_atol(av[3]) * 1e3;
-	table->time_to_sleep = ft_atol(av[4]) * 1e3;
-	if (table->time_to_die < 6e4
-		|| table->time_to_sleep < 6e4
-		|| table->time_to_eat < 6e4)
-		error_exit("Use timestamps major than 60ms");
-	if (av[5])
-		table->nbr_limit_meals = ft_atol(av[5]);
-	else
-		table->nbr_limit_meals = -1;
+	if (!parse_times(table, av))
+		return (false);
+	table->nbr_limit_meals = -1;
+	if (NULL == av[5])
+		return (true);
+	table->nbr_limit_meals = ft_atol(table, av[5]);
+	return (table->nbr_limit_meals >= 0);
 }
@@ -36,8 +36,36 @@
  *      - pthread_mutex_lock: Locks a mutex.
  *      - pthread_mutex_unlock: Unlocks a mutex.
  *
- * 9. <sys/time.h>:
- *      - gettimeofday: Gets the current time.
+ * 9. <time.h>:
+ *      - clock_gettime: Gets the current CLOCK_MONOTONIC time.
+ *      - clock_nanosleep: Sleeps until an absolute time (TIMER_ABSTIME).
+ *
+ * 10. <ucontext.h>:
+ *      - getcontext / makecontext / swapcontext: coroutines of the
+ *        CORO engine (coro.c).
+ *
+ * 11. <sys/mman.h>:
+ *      - mmap / munmap: one lazy mapping for all the coroutine stacks.
+ *
+ * 12. <stdatomic.h>:
+ *      - atomic_load_explicit / atomic_store_explicit: lock-free
+ *        reads and writes of the shared philo & table flags.
+ *      - atomic_fetch_add_explicit: lock-free counters.
+ *
+ * 13. <linux/futex.h> + <sys/syscall.h>, in futex.c only:
+ *      - futex: park / wake on a 32 bits word, the --lock=
+ *        ticket|mcs|hybrid fork locks and the instant wake up
+ *        of every sleeper at the end (futex.c).
+ *
+ * 14. <semaphore.h>:
+ *      - sem_init / sem_wait / sem_post: process shared semaphores
+ *        of --strategy=semaphore and --engine=process (process.c).
+ *
+ * 15. <signal.h>:
+ *      - kill: SIGKILL the children of --engine=process at the death.
+ *
+ * 16. "libphilo.h":
+ *      - the public API of libphilo.a, its error codes (libphilo.c).
  */
 # include <stdio.h>
 # include <stdlib.h>
@@ -48,8 +76,14 @@
 # include <errno.h>
 # include <string.h>
 # include <pthread.h>
-# include <sys/time.h>
+# include <time.h>
 # include <limits.h>
+# include <stdatomic.h>
+# include <ucontext.h>
+# include <sys/mman.h>
+# include <semaphore.h>
+# include <signal.h>
+# include "libphilo.h"
 
 /*
  * While compiling use this
@@ -60,6 +94,24 @@
 #  define DEBUG_MODE 0
 # endif
 
+/*
+ * METRICS
+ * ~make METRICS=1 to compile in the instrumentation,
+ * report on stderr at the end of the dinner
+*/
+# ifndef METRICS
+#  define METRICS 0
+# endif
+
+/*
+ * NUMA
+ * ~make NUMA=1 links libnuma: --affinity binds the philos
+ * 	memory with numa_tonode_memory instead of first touch
+*/
+# ifndef NUMA
+#  define NUMA 0
+# endif
+
 /*
  * PHILO MAX
  * by default 200
@@ -68,12 +120,106 @@
 #  define PHILO_MAX 200 
 # endif
 
+/*
+ * CORO ENGINE
+ * ~CORO_PHILO_MAX: philos limit with --engine=coro and --virtual-time
+ * 	(PHILO_MAX is for threads)
+ * ~CORO_STACK_SIZE: bytes of stack per coroutine, pages are lazy
+ * ~CORO_IDLE_NS: max nap of an idle worker before trying to steal again
+ * ~CORO_RING_MAX: max events in a worker log ring
+*/
+# ifndef CORO_PHILO_MAX
+#  define CORO_PHILO_MAX 1000000
+# endif
+# define CORO_STACK_SIZE 32768
+# define CORO_IDLE_NS 100000L
+# define CORO_RING_MAX 262144
+
+/*
+ * ASYNC LOGGER
+ * ~LOG_RING_SIZE: events per philo ring, power of 2 (index & mask)
+ * ~LOG_FLUSH_US: writer thread nap between two batches
+ * ~LOG_GRACE_NS: events younger than this wait for the next batch,
+ * 		so a late push from another philo is still merged in order
+ * ~LOG_BUF_SIZE: bytes flushed with a single write(2)
+*/
+# ifndef LOG_RING_SIZE
+#  define LOG_RING_SIZE 256
+# endif
+# define LOG_FLUSH_US 500
+# define LOG_GRACE_NS 1000000L
+# define LOG_BUF_SIZE 65536
+# define LOG_LINE_MAX 256
+
+/*
+ * FORK LOCKS, --lock=ticket|mcs|hybrid
+ * spins on the fork before parking on a futex:
+ * a fork is held t_eat, but handed over in a few ns
+*/
+# define LOCK_SPIN 128
+
+/*
+ * BACKOFF STRATEGY
+ * pause after a failed try lock, doubles from MIN to MAX
+*/
+# define BACKOFF_MIN_NS 50000L
+# define BACKOFF_MAX_NS 2000000L
+
+/*
+ * SHARDED MONITORS
+ * ~MONITOR_SLICE: philos per monitor thread before the default
+ * 		adds another one (never more monitors than cores)
+*/
+# define MONITOR_SLICE 4096
+
+/*
+ * AFFINITY
+ * ~AFFINITY_NODE_MAX: NUMA nodes looked up in sysfs
+*/
+# define AFFINITY_NODE_MAX 64
+
+/*
+ * TRACE, RECORD / REPLAY
+ * ~TRACE_PHILO_RECORDS: flight recorder depth per philo, power of 2
+ * ~TRACE_SEG_MAX: records cap of one segment (16 bytes each)
+ * ~REPLAY_POLL_NS: a philo waiting his turn looks at the end
+ * 	of the dinner this often
+ * ~REPLAY_RECHECK_NS: a death the recording does not have,
+ * 	the monitor looks again this much later
+*/
+# define TRACE_MAGIC "PHTRACE1"
+# define REPLAY_MAGIC "PHREPLY1"
+# define REPLAY_VERSION 1
+# define REPLAY_POLL_NS 1000000L
+# define REPLAY_RECHECK_NS 100000L
+# define TRACE_VERSION 1
+# define TRACE_PHILO_RECORDS 16384
+# define TRACE_SEG_MAX 16777216
+
+/*
+ * SHM STATS PAGE, --shm=name, see shm.c
+ * ~SHM_PUBLISH_NS: the writer copies its counters to the
+ * 	page at most this often, the viewer never sees older
+*/
+# define SHM_MAGIC "PHSHM001"
+# define SHM_VERSION 1
+# define SHM_PUBLISH_NS 10000000L
+# define SHM_NAME_MAX 64
+
+/*
+ * CACHE LINE
+ * Hot shared data gets its own line, no false sharing
+ * between a writer and the threads reading next to it
+*/
+# define CACHE_LINE 64
+
 /**
  * Enum: Philosopher States
  *
  * Represents the different states a philosopher can be in during the simulation
  * These states are used to format the output and reflect the 
  * current action or condition of a philosopher.
+ * DROP_FORK is never printed, only --trace records it.
 */
 typedef enum e_status
 {
@@ -83,8 +229,89 @@ typedef enum e_status
 	TAKE_FIRST_FORK,
 	TAKE_SECOND_FORK,
 	DIED,
+	DROP_FORK,
 }			t_philo_status;
 
+/*
+ * EXECUTION ENGINES
+ * ~THREAD: one pthread per philo, the classic
+ * ~CORO: philos are coroutines on a pool of worker threads
+ * ~VIRTUAL: single thread discrete-event simulation, no real clock
+ * ~PROCESS: one forked process per philo, shared memory semaphores
+*/
+typedef enum e_engine
+{
+	ENGINE_THREAD,
+	ENGINE_CORO,
+	ENGINE_VIRTUAL,
+	ENGINE_PROCESS,
+}			t_engine;
+
+/*
+ * THINK TIME POLICY, --think=fixed|adaptive
+ * ~FIXED: default, 42% of 2 * t_eat - t_sleep for odd N,
+ * 	30ms stagger
+ * ~ADAPTIVE: opt-in, aims at the ideal rotation, learns from
+ * 	the fork waits and the neighbours, see think.c
+*/
+typedef enum e_think
+{
+	THINK_FIXED,
+	THINK_ADAPTIVE,
+}			t_think;
+
+/*
+ * A thread of the libphilo pool, see pool.c
+ * ~IDLE: parked, no job
+ * ~READY: job handed over, running
+ * ~DONE: job returned, waiting for its join
+ * ~EXIT: the pool is destroyed
+*/
+typedef enum e_pool_state
+{
+	POOL_IDLE,
+	POOL_READY,
+	POOL_DONE,
+	POOL_EXIT,
+}			t_pool_state;
+
+/*
+ * How a --batch scenario ended, see batch.c
+ * ~ERROR: the line was refused, nothing ran
+ * ~FULL: everybody ate the meals limit
+ * ~SURVIVED: nobody died before the --duration horizon
+ * ~DIED: somebody starved
+*/
+typedef enum e_outcome
+{
+	OUTCOME_ERROR,
+	OUTCOME_FULL,
+	OUTCOME_SURVIVED,
+	OUTCOME_DIED,
+}			t_outcome;
+
+/*
+ * What a VIRTUAL philo does when its next event fires
+*/
+typedef enum e_vstep
+{
+	V_TAKE_FIRST,
+	V_TAKE_SECOND,
+	V_DROP_FORKS,
+	V_THINK,
+}			t_vstep;
+
+/*
+ * What a coroutine asks the scheduler when it switches out
+*/
+typedef enum e_coro_state
+{
+	CORO_READY,
+	CORO_SLEEP,
+	CORO_PARK,
+	CORO_DONE,
+}			t_coro_state;
+
 /**
  * Represents different units of time for use with a gettime function,
  * which can be used to get the current time or measure durations in
@@ -95,8 +322,36 @@ typedef enum e_time_code
 	SECONDS,
 	MILLISECOND,
 	MICROSECOND,
+	NANOSECOND,
 }		t_time_code;
 
+/*
+ * TIME ENGINE, everything is NANOSECOND integer math
+ * ~SPIN_MIN_NS / SPIN_MAX_NS: bounds of the calibrated spin window
+ * ~CALIBRATION_ROUNDS: sleeps measured at start for the spin window
+ * ~HIRES_MIN_NS: shortest t_die / t_eat / t_sleep with --hires (100 us),
+ * 				60 ms otherwise
+ * ~HIRES_SPIN_MIN_NS: spin window floor with --hires, the timer slack
+ * 				is 1 ns there, the kernel wakes up in a few us
+*/
+# define NSEC_PER_USEC 1000L
+# define NSEC_PER_MSEC 1000000L
+# define NSEC_PER_SEC 1000000000L
+# define SPIN_MIN_NS 50000L
+# define SPIN_MAX_NS 1000000L
+# define CALIBRATION_ROUNDS 20
+# define HIRES_MIN_NS 100000L
+# define HIRES_SPIN_MIN_NS 2000L
+
+/*
+ * BATCH, --batch=file, see batch.c
+ * ~BATCH_DURATION_MS: horizon of a scenario when no --duration
+ * 	is given, a config that never dies must end somewhere
+ * ~ERROR_MAX: room for the error of one table
+*/
+# define BATCH_DURATION_MS 10000
+# define ERROR_MAX 128
+
 /*
  * ENUM to handle all the mutex & thread functions
  * with a clean API interface
@@ -110,6 +365,8 @@ typedef enum e_opcode
 	CREATE,
 	JOIN,
 	DETACH,
+	BROADCAST,
+	SIGNAL,
 }			t_opcode;
 
 /*
@@ -129,6 +386,16 @@ typedef enum e_opcode
 # define C      "\033[1;36m"   /* Bold Cyan */
 # define W      "\033[1;37m"   /* Bold White */
 
+/*
+ * LINE TEMPLATES, format.c
+ * Placeholders inside the precomputed status lines,
+ * bytes no color code or emoji ever contains
+*/
+# define TPL_TIME "\1"
+# define TPL_ID "\2"
+# define TPL_AUX "\3"
+# define TPL_MARKS "\1\2\3"
+
 //*******************************    STRUCTS    *******************************
 
 /*
@@ -137,18 +404,650 @@ typedef enum e_opcode
  * Typedef mutex, way to long pthread_mutex_t
 */
 typedef struct s_table	t_table;
+typedef struct s_coro	t_coro;
+typedef struct s_philo	t_philo;
 typedef pthread_mutex_t	t_mtx;
+typedef pthread_cond_t	t_cond;
+
+/*
+ * Atomic types for the data shared between
+ * philos and monitor: no mutex needed anymore
+ * to read or write them 🔓
+*/
+typedef atomic_bool		t_abool;
+typedef atomic_long		t_along;
+
+/*
+ * MCS queue node, 1 per fork a philo can hold (philo->mcs).
+ * The waiter spins on ITS node, not on the fork
+ * ~locked:	1 while the predecessor holds the fork (futex word)
+ * ~parked:	the waiter sleeps in the kernel, wake it
+*/
+typedef struct s_mcs_node
+{
+	struct s_mcs_node *_Atomic	next;
+	atomic_uint					locked;
+	atomic_uint					parked;
+}								t_mcs_node;
+
+/*
+ * TICKET lock: take a number, wait for it to be served, FIFO
+ * ~parked:	waiters sleeping on the serving futex
+*/
+typedef struct s_ticket
+{
+	atomic_uint	next;
+	atomic_uint	serving;
+	atomic_uint	parked;
+}				t_ticket;
 
 /*
  * FORK
  * I make it as a struct, id useful for debugging
+ *
+ * CORO engine only: the mutex just guards owner & waiter
+ * for a few instructions, a coroutine never blocks its worker
+ * on a fork, it parks and the owner hands the fork over.
+ * A fork has 2 neighbours, so 1 waiter max.
+ *
+ * 🔥 One fork per cache line: neighbour mutexes are
+ * 	locked by different philos at the same time 🔥
+ *
+ * One lock word per fork, the --lock=name in use:
+ * 	~fork:		pthread (default, CORO, chandy)
+ * 	~ticket:	ticket
+ * 	~tail:		mcs, last node of the queue
+ * 	~word:		hybrid, 0 free, 1 taken, 2 taken with sleepers
 */
-typedef struct s_fork
+typedef struct __attribute__((aligned(CACHE_LINE))) s_fork
 {
-	t_mtx		fork;
+	union
+	{
+		t_mtx				fork;
+		t_ticket			ticket;
+		t_mcs_node *_Atomic	tail;
+		atomic_uint			word;
+	};
 	int			fork_id;
+	t_coro		*owner;
+	t_coro		*waiter;
 }				t_fork;
 
+/*
+ * FORK LOCK, --lock=name
+ * How take_fork / drop_fork lock a fork with the THREAD engine.
+ * ~try:	true if the fork was free and is now ours
+*/
+typedef struct s_fork_lock
+{
+	const char	*name;
+	void		(*lock)(t_philo *philo, t_fork *fork);
+	bool		(*try)(t_philo *philo, t_fork *fork);
+	void		(*unlock)(t_philo *philo, t_fork *fork);
+}				t_fork_lock;
+
+/*
+ * FORK STRATEGY, --strategy=name
+ * How a philo gets his 2 forks before eating and gives them back.
+ * acquire writes the 2 "has taken a fork" lines itself,
+ * the order depends on the strategy.
+ * ~init / destroy: strategy private data in table->strat, may be NULL
+*/
+typedef struct s_strategy
+{
+	const char	*name;
+	void		(*init)(t_table *table);
+	void		(*acquire)(t_philo *philo);
+	void		(*release)(t_philo *philo);
+	void		(*destroy)(t_table *table);
+}				t_strategy;
+
+/*
+ * CHANDY-MISRA fork, next to the t_fork with the same index
+ * ~holder:		philo index owning the fork
+ * ~dirty:		used since the last hand over, must be given on request
+ * ~in_use:		holder is eating with it
+ * ~requested:	the neighbour asked for it (the message)
+ * ~handed:		cond, the neighbour waits here for the fork
+*/
+typedef struct s_cm_fork
+{
+	t_cond		handed;
+	long		holder;
+	bool		dirty;
+	bool		in_use;
+	bool		requested;
+}				t_cm_fork;
+
+/*
+ * Private data of the strategies
+ * ~seats:		WAITER, free seats (N-1 at start) + mutex and cond
+ * ~cm:			CHANDY, one t_cm_fork per fork
+*/
+typedef struct s_strat_data
+{
+	t_mtx		seats_mutex;
+	t_cond		seats_cond;
+	long		seats;
+	t_cm_fork	*cm;
+}				t_strat_data;
+
+/*
+ * OPTIONS, --flags before the classic arguments
+ * ~engine:		--engine=thread|coro|process
+ * ~workers:		--workers=N, CORO engine threads (default: cores)
+ * ~seed:		--seed=N, VIRTUAL engine tie breaks
+ * ~duration:	--duration=ms, horizon from the start (NANOSECOND),
+ * 				LONG_MAX: none
+ * ~quiet:		--quiet, VIRTUAL engine prints only the death
+ * ~strategy:	--strategy=hierarchy|waiter|chandy|backoff|semaphore
+ * ~monitors:	--monitors=K, monitor threads (0: from cores and N)
+ * ~affinity:	--affinity, pin the threads, node local philos memory
+ * ~trace:		--trace=file, binary trace path (NULL: off)
+ * ~think:		--think=fixed|adaptive
+ * ~lock:		--lock=pthread|ticket|mcs|hybrid, THREAD engine forks
+ * ~batch:		--batch=file, scenarios to run (NULL: the classic args)
+ * ~jobs:		--jobs=N, tables running at once in batch (default: cores)
+ * ~hires:		--hires, t_die t_eat t_sleep in MICROSECONDS, see utils.c
+ * ~stamp_us:	--stamp=us, timestamps printed 12.345 ms (default ms)
+ * ~record:		--record=file, fork grants order written there
+ * ~replay:		--replay=file, the grants follow that order
+ * ~shm:		--shm=name, live stats page in POSIX shared memory
+*/
+typedef struct s_options
+{
+	t_engine		engine;
+	long			workers;
+	unsigned long	seed;
+	long			duration;
+	bool			quiet;
+	const t_strategy	*strategy;
+	long			monitors;
+	bool			affinity;
+	const char		*trace;
+	t_think			think;
+	const t_fork_lock	*lock;
+	const char		*batch;
+	long			jobs;
+	bool			hires;
+	bool			stamp_us;
+	const char		*record;
+	const char		*replay;
+	const char		*shm;
+}				t_options;
+
+/*
+ * THREAD POOL, libphilo only, see pool.c
+ * One slot per parked thread, state is its futex word.
+ * The slots are allocated one by one: a growing pool
+ * never moves the slot a thread sleeps on
+*/
+typedef struct s_pool_slot
+{
+	pthread_t	thread;
+	void		*(*fn)(void *);
+	void		*arg;
+	atomic_uint	state;
+}				t_pool_slot;
+
+typedef struct s_pool
+{
+	t_pool_slot	**slots;
+	long		nbr;
+	long		cap;
+}				t_pool;
+
+/*
+ * How a dinner ended, see table_outcome
+ * ~outcome:	see t_outcome
+ * ~dead_id / died_ms:	who starved, when (ms from the start)
+ * ~meals_min / meals_max:	meals of the least / most fed philo
+ * ~wall:		NANOSECOND, real time the table took
+*/
+typedef struct s_result
+{
+	t_outcome	outcome;
+	long		dead_id;
+	long		died_ms;
+	long		meals_min;
+	long		meals_max;
+	long		wall;
+}				t_result;
+
+/*
+ * BATCH, one scenario = one line of the file = one table
+ * ~line:		line number in the file
+ * ~av:			argv-like, av[1..4] + the optional av[5] meals,
+ * 				pointing inside the file buffer
+ * ~res:		the result of its table
+ * ~error:		why the line was refused
+*/
+typedef struct s_scenario
+{
+	long		line;
+	char		*av[7];
+	t_result	res;
+	char		error[ERROR_MAX];
+}				t_scenario;
+
+/*
+ * ~opt:		the command line options, copied in every table
+ * ~text:		the whole file, the scenarios point inside
+ * ~next:		next scenario to run, the workers fetch_add it
+ * ~spin_ns:	calibrated once for every table
+ * ~print_mutex:	one result line at a time on stdout
+*/
+typedef struct s_batch
+{
+	t_options	opt;
+	char		*text;
+	t_scenario	*scenarios;
+	long		nbr;
+	t_along		next;
+	long		spin_ns;
+	pthread_t	*workers;
+	t_mtx		print_mutex;
+}				t_batch;
+
+/*
+ * LOG EVENT
+ * Fixed size record pushed by the philos, the writer
+ * thread does all the formatting.
+ * ~time:	absolute timestamp in NANOSECOND
+ * ~aux:	fork_id or meals_counter for the debug output, death deadline
+*/
+typedef struct s_event
+{
+	long		time;
+	long		aux;
+	int			philo_id;
+	int			status;
+	bool		debug;
+}				t_event;
+
+/*
+ * LOG-LINEAR HISTOGRAM (HdrHistogram style), METRICS=1 only
+ * Values in NANOSECOND, HIST_SUB buckets for every power of 2:
+ * relative error < 1/HIST_SUB at any magnitude, fixed memory.
+ * 1 writer per histogram, no atomics needed
+*/
+# define HIST_SUB_BITS 4
+# define HIST_SUB 16
+# define HIST_BUCKETS 1024
+
+typedef struct s_hist
+{
+	long		counts[HIST_BUCKETS];
+	long		total;
+	long		min;
+	long		max;
+}				t_hist;
+
+/*
+ * Per fork counters, METRICS=1 only.
+ * Written by the philo holding the fork: the fork itself
+ * orders the writes, no atomics
+ * ~wait:	take_fork call -> fork in hand
+ * ~taken:	when the current holder got it
+*/
+typedef struct __attribute__((aligned(CACHE_LINE))) s_fork_stats
+{
+	t_hist		wait;
+	long		taken;
+	long		hold_total;
+	long		hold_max;
+}				t_fork_stats;
+
+/*
+ * SPSC RING
+ * 1 producer (the philo, or the coroutine worker) 1 consumer (the writer).
+ * head and tail grow forever, slot = index & mask
+ * size is a power of 2, mask = size - 1
+ * ~push_wait: METRICS=1, time the producer waited for a free slot
+ * ~busy: 1 while the producer is between its end check and its
+ * 		push, the writer waits for 0 before the last drain
+*/
+typedef struct s_ring
+{
+	t_along		head;
+	t_along		tail;
+	t_along		busy;
+	long		mask;
+	t_event		*events;
+	t_hist		*push_wait;
+}				t_ring;
+
+/*
+ * LOG
+ * ~rings:			one per producer thread
+ * ~ring_size:		events per ring, power of 2
+ * ~pending:		events drained but not written yet (sorted)
+ * ~tmp:			scratch array for the merge sort
+ * ~buf:			output batch, flushed with write(2)
+ * ~death:			the DIED event, published by death_posted
+ * ~fd:			where the batches go, stdout (-1: nowhere, --batch)
+ * ~sink:		libphilo, every line goes to it as an event instead,
+ * 				with sink_ctx and the start of the simulation
+ * ~closed:		main thread says no more events will come
+ * ~wake:		futex word, bumped by the death and the close:
+ * 				the writer naps on it between 2 batches
+ * ~writer:		the writer thread
+*/
+typedef struct s_log
+{
+	t_ring		*rings;
+	long		ring_nbr;
+	long		ring_size;
+	t_event		*events;
+	t_event		*pending;
+	t_event		*tmp;
+	long		pending_nbr;
+	char		*buf;
+	long		buf_len;
+	int			fd;
+	void		(*sink)(void *ctx, t_event *ev, long start);
+	void		*sink_ctx;
+	t_event		death;
+	t_abool		death_posted;
+	t_abool		closed;
+	atomic_uint	wake;
+	pthread_t	writer;
+}				t_log;
+
+/*
+ * TRACE FILE, --trace=file, see trace.c
+ * [head][seg_nbr segs][records of seg 0][records of seg 1]...
+ * One segment per log ring (philo or worker) + 1 for the DIED,
+ * each one written by a single thread.
+ * A segment is a flight recorder: count only grows,
+ * record n lives at first + (n & (capacity - 1))
+ *
+ * ~time:	absolute NANOSECOND, head->start is the simulation start
+ * ~kind:	t_philo_status | aux << 8 (fork_id, meals counter)
+*/
+typedef struct s_trace_head
+{
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	seg_nbr;
+	int64_t		philo_nbr;
+	int64_t		start;
+	int64_t		time_to_die;
+	int64_t		time_to_eat;
+	int64_t		time_to_sleep;
+	int64_t		reserved;
+}				t_trace_head;
+
+typedef struct s_trace_seg
+{
+	int64_t		count;
+	int64_t		capacity;
+	int64_t		first;
+	int64_t		reserved[5];
+}				t_trace_seg;
+
+typedef struct s_trace_rec
+{
+	int64_t		time;
+	uint32_t	philo_id;
+	uint32_t	kind;
+}				t_trace_rec;
+
+typedef struct s_trace
+{
+	void			*map;
+	size_t			len;
+	int				fd;
+	t_trace_head	*head;
+	t_trace_seg		*segs;
+	t_trace_rec		*recs;
+}				t_trace;
+
+/*
+ * RECORD / REPLAY, --record=file --replay=file, see replay.c
+ * [head][philo_nbr grant counts][grant bits of fork 0][fork 1]...
+ * The k-th grant of a fork is 1 bit: 0 the philo at its index,
+ * 1 the one before him (the 2 philos sharing it)
+ *
+ * ~dead:		philo index the monitor declared, -1 nobody
+ * ~died_at:	since the start, NANOSECOND
+*/
+typedef struct s_replay_head
+{
+	char		magic[8];
+	int64_t		version;
+	char		strategy[16];
+	int64_t		philo_nbr;
+	int64_t		time_to_die;
+	int64_t		time_to_eat;
+	int64_t		time_to_sleep;
+	int64_t		meals;
+	int64_t		dead;
+	int64_t		died_at;
+}				t_replay_head;
+
+/*
+ * One fork, one cache line:
+ * ~record: only the holder appends, like fork_stats
+ * ~replay: next is the grant index, the futex word
+ * 	the philos wait their turn on
+*/
+typedef struct __attribute__((aligned(CACHE_LINE))) s_grants
+{
+	uint8_t		*bits;
+	long		nbr;
+	long		cap;
+	atomic_uint	next;
+}				t_grants;
+
+/*
+ * ~head:		record: filled at the end, replay: the recording
+ * ~left:		replay, recorded grants each philo still has to get
+ * ~deferred:	replay, deaths the monitor saw that the
+ * 				recording did not have (the replay runs a bit late)
+ * ~died_at:	replay, the death of this run, to compare
+*/
+typedef struct s_replay
+{
+	t_grants		*forks;
+	t_replay_head	head;
+	t_along			*left;
+	atomic_long		deferred;
+	long			died_at;
+}				t_replay;
+
+/*
+ * SHM STATS PAGE, --shm=name, see shm.c
+ * [head][stats][philo_nbr philos], one writer: the log writer
+ *
+ * ~head:	written once, seq is the seqlock, odd while
+ * 			the writer copies stats and philos
+ * ~start:	CLOCK_MONOTONIC of the start, 0 until the first event
+ * ~now:	last published event, since the start
+ * ~real:	1: the viewer clock minus start is now,
+ * 			0: virtual time, only now counts
+ * ~pile:	--strategy=semaphore, forks have no owner
+ * ~dead:	philo id, 0 nobody
+ * ~state:	t_philo_status of the last line, -1 before any
+ * ~owner:	philo id holding the fork at his index, 0 free
+ *
+ * 🚨 Fixed sizes only, the viewer is another binary:
+ * 	int64_t, int32_t, seq a lock free 8 bytes atomic 🚨
+*/
+typedef struct s_shm_head
+{
+	char		magic[8];
+	int64_t		version;
+	int64_t		philo_nbr;
+	int64_t		pid;
+	t_along		seq;
+}				t_shm_head;
+
+typedef struct s_shm_stats
+{
+	char		engine[16];
+	char		strategy[16];
+	int64_t		time_to_die;
+	int64_t		time_to_eat;
+	int64_t		time_to_sleep;
+	int64_t		meals_limit;
+	int64_t		start;
+	int64_t		now;
+	int64_t		real;
+	int64_t		pile;
+	int64_t		meals_total;
+	int64_t		events;
+	int64_t		ended;
+	int64_t		dead;
+}				t_shm_stats;
+
+typedef struct s_shm_philo
+{
+	int64_t		meals;
+	int64_t		last_meal;
+	int32_t		state;
+	int32_t		owner;
+}				t_shm_philo;
+
+/*
+ * Writer side
+ * ~stats, philos:	private copies, every event updates them
+ * ~dirty:			philos changed since the last publish,
+ * 					only those are copied to the page
+ * ~next:			earliest next publish, NANOSECOND
+*/
+typedef struct s_shm
+{
+	void		*map;
+	size_t		len;
+	char		name[SHM_NAME_MAX];
+	t_shm_head	*head;
+	t_shm_stats	*page_stats;
+	t_shm_philo	*page_philos;
+	t_shm_stats	stats;
+	t_shm_philo	*philos;
+	long		*dirty;
+	char		*is_dirty;
+	long		dirty_nbr;
+	long		next;
+}				t_shm;
+
+/*
+ * DEADLINE HEAP
+ * Monitor min-heap, one node per philo still eating
+ * ~when:		absolute death time in NANOSECOND
+ * ~philo_idx:	position in table->philos
+ * ~tie:		order of equal deadlines, 0 for the monitor
+*/
+typedef struct s_deadline
+{
+	long			when;
+	long			philo_idx;
+	unsigned long	tie;
+}				t_deadline;
+
+typedef struct s_heap
+{
+	t_deadline	*nodes;
+	long		size;
+}				t_heap;
+
+/*
+ * START GATE
+ * ~expected:		threads that must check in (philos + monitors)
+ * ~all_arrived:	main sleeps on it until arrived == expected
+ * ~opened:		threads sleep on it until main opens the gate
+*/
+typedef struct s_gate
+{
+	t_mtx		mutex;
+	t_cond		all_arrived;
+	t_cond		opened;
+	long		expected;
+	long		arrived;
+	bool		open;
+}				t_gate;
+
+/*
+ * METRICS, only filled with METRICS=1
+ * ~create:		MICROSECOND, before the first pthread_create
+ * ~release:		MICROSECOND, start gate opened
+ * ~last_awake:	MICROSECOND, last thread out of the gate
+ * ~death_latency:	deadline of the dead philo -> DIED line written
+ * 	(the monitor period lives in every t_monitor, one writer each)
+ * ~kill:		PROCESS engine, death posted -> SIGKILL to the children
+ * ~died_at:	NANOSECOND, the death was claimed (0: nobody died)
+ * ~shutdown:	died_at -> every thread of the dinner joined
+*/
+typedef struct s_metrics
+{
+	long		create;
+	long		release;
+	t_along		last_awake;
+	t_hist		death_latency;
+	long		kill;
+	long		died_at;
+	long		shutdown;
+}				t_metrics;
+
+/*
+ * AFFINITY, --affinity only, see affinity.c
+ * ~cpus:		usable cpus sorted by node, last level cache, core:
+ * 				neighbours in the array share a cache
+ * ~philo_cpus:	the first philo_cpus run philos (or workers),
+ * 				the others are reserved to the monitors
+ * ~node_nbr:	distinct NUMA nodes in cpus
+*/
+typedef struct s_cpu
+{
+	long	cpu;
+	long	node;
+	long	llc;
+	long	core;
+}				t_cpu;
+
+typedef struct s_affinity
+{
+	t_cpu	*cpus;
+	long	cpu_nbr;
+	long	philo_cpus;
+	long	node_nbr;
+}				t_affinity;
+
+/*
+ * MONITOR SHARD
+ * One monitor thread, watching the philos [lo, hi)
+ * with its own deadline heap, see monitor_shards.c
+ * ~period:	METRICS=1, time between two wake ups of this monitor
+*/
+typedef struct __attribute__((aligned(CACHE_LINE))) s_monitor
+{
+	pthread_t	thread;
+	long		id;
+	long		lo;
+	long		hi;
+	t_table		*table;
+	t_hist		period;
+}				t_monitor;
+
+/*
+ * FAIRNESS, per philo, METRICS=1 only
+ * Written by the philo itself (no lock, no atomic),
+ * read by main after the join.
+ * ~want:		NANOSECOND, started to want the forks
+ * ~wait_total:	sum of fork waits (want -> second fork)
+ * ~wait_max:	worst fork wait
+ * ~max_gap:	longest time between 2 meals (start -> first meal too),
+ * 				time_to_die - max_gap is the starvation margin
+*/
+typedef struct __attribute__((aligned(CACHE_LINE))) s_fairness
+{
+	long		want;
+	long		wait_total;
+	long		wait_max;
+	long		max_gap;
+}				t_fairness;
+
 /*
 ** Struct s_philo - Represents a philosopher in the dining philosophers problem.
 **
@@ -160,23 +1059,157 @@ typedef struct s_fork
 ** - thread_id:     	Thread ID for the philosopher's thread.
 ** - first_fork:    	Pointer to the philosopher's first fork to take.
 ** - second_fork:   	Pointer to the philosopher's secon fork.
-** - philo_data_mutex: 	Mutex for managing data races (access philo data
-							concurrently) with the monitor thread)
+** - ring:          	Log ring, only this philo pushes in it (SPSC).
+**						CORO engine: the ring of the worker running him.
+** - coro:          	His coroutine, NULL with the THREAD engine.
+** - think_end:     	--think=adaptive, when his last thinking ends,
+**						read by his neighbours.
+** - think_lead:    	--think=adaptive, how much earlier than the
+**						ideal slot he comes to the forks.
+** - mcs:           	--lock=mcs queue nodes, [0] first_fork [1] second.
 ** - table:		    	Pointer to table data, every philo can access
 							all the "global data" in tabl in table.
+**
+** full, meals_counter and last_meal_time are read concurrently
+** by the monitor thread, so they are atomics (see getters_setters.c)
+**
+** 🔥 Cache line aligned, hot atomics first: the meal
+** 	writes of a philo never invalidate the line of
+** 	his neighbours. The monitor does not even read them,
+** 	it scans table->deadlines 🔥
 */
-typedef struct s_philo
+struct __attribute__((aligned(CACHE_LINE))) s_philo
 {
+	t_along			last_meal_time;
+	t_along			meals_counter;
+	t_abool			full;
+	t_along			think_end;
 	int				id;
-	bool			full;
-	long			meals_counter;
-	long			last_meal_time;
+	long			think_lead;
 	pthread_t		thread_id;
 	t_fork			*first_fork;
 	t_fork			*second_fork;
-	t_mtx			philo_mutex;
+	t_ring			*ring;
+	t_coro			*coro;
 	t_table			*table;
-}				t_philo;
+	t_mcs_node		mcs[2];
+};
+
+/*
+ * COROUTINE, one per philo with --engine=coro
+ * ~ctx:		saved registers + stack
+ * ~worker:		worker running it right now (it can be stolen)
+ * ~state:		what it asked the scheduler when it switched out
+ * ~wake:		CORO_SLEEP, absolute NANOSECOND deadline
+ * ~park_fork:	CORO_PARK, fork to wait for
+*/
+struct s_coro
+{
+	ucontext_t			ctx;
+	struct s_worker		*worker;
+	t_philo				*philo;
+	t_coro_state		state;
+	long				wake;
+	long				idx;
+	t_fork				*park_fork;
+};
+
+/*
+ * WORKER thread of the CORO engine
+ * ~sched_ctx:	the scheduler loop, coroutines switch back here
+ * ~queue:		runnable coroutines (ring buffer), guarded by
+ * 				queue_mutex because other workers steal from the back
+ * ~timers:		sleeping coroutines, deadline heap
+ * ~ring:		log ring of this worker
+*/
+typedef struct s_worker
+{
+	pthread_t			thread;
+	ucontext_t			sched_ctx;
+	t_mtx				queue_mutex;
+	t_coro				**queue;
+	long				q_head;
+	long				q_size;
+	t_heap				timers;
+	t_ring				*ring;
+	long				id;
+	t_table				*table;
+}				t_worker;
+
+/*
+ * SCHEDULER of the CORO engine
+ * ~stacks:		one mmap for every coroutine stack
+ * ~done:		coroutines that returned, workers stop at philo_nbr
+*/
+typedef struct s_sched
+{
+	t_worker			*workers;
+	t_coro				*coros;
+	char				*stacks;
+	size_t				stacks_len;
+	t_along				done;
+}				t_sched;
+
+/*
+ * VIRTUAL ENGINE
+ * ~events:		min-heap of (virtual time, random tie), 1 per philo max
+ * ~deaths:		same lazy deadline heap of the monitor
+ * ~steps:		per philo, what its next event means
+ * ~owner/waiter:	per fork philo index, -1 if nobody
+ * ~now:		virtual NANOSECOND, the simulation starts at 0
+ * ~rng:		xorshift state, seeded by --seed
+ * ~handled:	events processed, for the summary
+ * ~dead:		index of the dead philo, -1 if nobody died
+*/
+typedef struct s_virtual
+{
+	t_heap			events;
+	t_heap			deaths;
+	t_vstep			*steps;
+	long			*owner;
+	long			*waiter;
+	long			now;
+	unsigned long	rng;
+	long			handled;
+	long			dead;
+}				t_virtual;
+
+/*
+ * PROCESS ENGINE, MAP_SHARED before the forks, see process.c
+ * ~forks:	counting semaphore, the pile of the N forks
+ * ~seats:	N / 2 philos try to eat at once, no deadlock
+ * ~arrived/go:	start rendezvous children <-> parent
+ * ~died:	the parent sleeps on it: a death or all children gone
+ * ~dead:	first death wins, across the processes
+ * ~start:	start_simulation, stamped by the parent
+ * ~posted:	NANOSECOND, death handed to the parent
+ * ~death:	the DIED event, the parent posts it to its writer
+*/
+typedef struct s_shared
+{
+	sem_t		forks;
+	sem_t		seats;
+	sem_t		arrived;
+	sem_t		go;
+	sem_t		died;
+	t_abool		dead;
+	long		start;
+	long		posted;
+	t_event		death;
+}				t_shared;
+
+/*
+ * ~pids:	children, parent side
+ * ~self:	philo index in a child, -1 in the parent
+ * ~reaper:	parent thread waiting for the children
+*/
+typedef struct s_process
+{
+	t_shared	*shared;
+	pid_t		*pids;
+	long		self;
+	pthread_t	reaper;
+}				t_process;
 
 /*
 ** Struct: s_table
@@ -186,7 +1219,7 @@ typedef struct s_philo
 ** a fairness performance array to track the fairness of resource
 ** allocation among philosophers (at the end they ate ~equal meals), a thread
 ** for monitoring the philosophers, an array of forks, an array of philosophers,
-** and a mutex for managing data races when writing to shared resources (stdout).
+** and the async logger writing to stdout.
 **
 ** Members:
 ** - time_to_die: Time after which a philosopher will die if they haven't eaten.
@@ -195,15 +1228,39 @@ typedef struct s_philo
 ** - nbr_limit_meals: The number of meals limit, if < 0 no limits.
 ** - philo_nbr: Total number of philosophers at the table.
 ** - start_simulation: The starting time of the simulation.
-** - end_simulation: when a philo die, this flag ON
-** - all_threads_ready: synchro the start of simulation
-							monitor-philos.
-** - threads_running_nbr: Helps me synchro the monitor thread
-** - monitor: Thread for monitoring the philosophers.
+** - spin_ns: busy wait window at the end of every sleep, calibrated
+**
+** 🚨 all the times are NANOSECOND, CLOCK_MONOTONIC 🚨
+** - end_simulation: when a philo die, this flag ON.
+							Read by everybody all the time:
+							alone on its cache line
+** - end_word: futex twin of end_simulation, every timed
+							sleep waits on it, see end_sleep_until
+** - start_gate: synchro the start of simulation
+							monitor-philos, see gate.c
+** - monitors: monitor_nbr threads, each one watching a contiguous
+							slice of the philos. The first death wins.
+** - monitor_mutex + monitor_cond: the monitors sleep on them until
+							their next deadline, stop_simulation wakes them.
 ** - forks: Pointer to an array of forks.
 ** - philosophers: Pointer to an array of philosophers.
-** - table_mutex: Useful to manage data races monitor-philos
-** - write_mutex: Mutex for managing data races when writing to stdout.
+** - fairness: per philo fork waits and meal gaps, METRICS=1 only.
+** - fork_stats: per fork lock waits and hold times, METRICS=1 only.
+** - deadlines: SoA, deadlines[i] = last meal of philos[i] + time_to_die,
+							LONG_MAX once full. The monitor reads only
+							this array, 8 philos per cache line.
+** - log: Per philo rings + writer thread, see logger.c
+** - trace: mmap-ed binary trace, --trace=file only
+** - replay: fork grants order, --record / --replay only
+** - shm: live stats page, --shm=name only
+** - opt: --flags from the command line
+** - aff: cpu placement, --affinity only
+** - strat: private data of the fork strategy, see strategy.c
+** - sched: coroutines and workers, CORO engine only
+** - virt: event queue and fork owners, VIRTUAL engine only
+** - proc: shared memory and children, PROCESS engine only
+** - error: why parse_options / parse_input refused the arguments
+** - pool: parked threads reused run after run, libphilo only
 */
 struct	s_table
 {
@@ -213,14 +1270,49 @@ struct	s_table
 	long				nbr_limit_meals;
 	long				philo_nbr;
 	long				start_simulation;
-	bool				end_simulation;
-	bool				all_threads_ready;
-	long				threads_running_nbr;
-	pthread_t			monitor;
+	long				spin_ns;
+	t_abool				end_simulation __attribute__((aligned(CACHE_LINE)));
+	atomic_uint			end_word;
+	t_gate				start_gate __attribute__((aligned(CACHE_LINE)));
+	t_monitor			*monitors;
+	long				monitor_nbr;
+	t_mtx				monitor_mutex;
+	t_cond				monitor_cond;
 	t_fork				*forks;
 	t_philo				*philos;
-	t_mtx				table_mutex;
-	t_mtx				write_mutex;
+	t_along				*deadlines;
+	t_fairness			*fairness;
+	t_fork_stats		*fork_stats;
+	t_strat_data		strat;
+	t_log				log;
+	t_trace				trace;
+	t_replay			replay;
+	t_shm				shm;
+	t_metrics			metrics;
+	t_options			opt;
+	t_affinity			aff;
+	t_sched				sched;
+	t_virtual			virt;
+	t_process			proc;
+	char				error[ERROR_MAX];
+	t_pool				*pool;
+};
+
+/*
+ * LIBPHILO HANDLE, see libphilo.c
+ * ~av:		the classic arguments, av + options of the caller
+ * ~opt:	parsed once, copied in the table of every run
+ * ~pool:	the threads, parked between the runs
+*/
+struct s_philo_table
+{
+	t_table				table;
+	char				*av[7];
+	t_options			opt;
+	long				spin_ns;
+	t_pool				pool;
+	t_philo_event_fn	fn;
+	void				*ctx;
 };
 
 //***************    PROTOTYPES     ***************
@@ -229,41 +1321,205 @@ struct	s_table
 void	safe_thread_handle(pthread_t *thread, void *(*foo)(void *),
 			void *data, t_opcode opcode);
 void	safe_mutex_handle(t_mtx *mutex, t_opcode opcode);
+void	safe_cond_handle(t_cond *cond, t_opcode opcode);
 void	*safe_malloc(size_t bytes);
+void	*safe_aligned_malloc(size_t bytes);
 
 //*** function to process the input ***
-void	parse_input(t_table *table, char **av);
+bool	parse_input(t_table *table, char **av);
+int		parse_options(t_table *table, int ac, char **av);
 
 //*** init table and philos data ***
 void	data_init(t_table *table);
 
 //*** function to kick in the dinner ***
 void	dinner_start(t_table *table);
+void	*dinner_simulation(void *data);
+void	*lone_philo(void *arg);
+
+//*** engine agnostic forks & sleep, see forks.c ***
+void	take_fork(t_philo *philo, t_fork *fork);
+void	drop_fork(t_philo *philo, t_fork *fork);
+void	philo_sleep_until(t_philo *philo, long deadline);
+
+//*** fork strategies, see strategy.c ***
+const t_strategy	*strategy_find(const char *name);
+void	hierarchy_acquire(t_philo *philo);
+void	hierarchy_release(t_philo *philo);
+void	waiter_init(t_table *table);
+void	waiter_acquire(t_philo *philo);
+void	waiter_release(t_philo *philo);
+void	waiter_destroy(t_table *table);
+void	chandy_init(t_table *table);
+void	chandy_acquire(t_philo *philo);
+void	chandy_release(t_philo *philo);
+void	chandy_destroy(t_table *table);
+void	backoff_acquire(t_philo *philo);
+void	backoff_release(t_philo *philo);
+
+//*** fork locks, see fork_lock.c ***
+const t_fork_lock	*lock_find(const char *name);
+bool	try_fork(t_philo *philo, t_fork *fork);
+void	mcs_lock(t_philo *philo, t_fork *fork);
+bool	mcs_try(t_philo *philo, t_fork *fork);
+void	mcs_unlock(t_philo *philo, t_fork *fork);
+void	hybrid_lock(t_philo *philo, t_fork *fork);
+bool	hybrid_try(t_philo *philo, t_fork *fork);
+void	hybrid_unlock(t_philo *philo, t_fork *fork);
+void	fork_stats_init(t_table *table);
+void	fork_stats_taken(t_table *table, t_fork *fork, long since);
+void	fork_stats_dropped(t_table *table, t_fork *fork);
+void	fork_stats_report(t_table *table);
+
+//*** CORO engine ***
+void	coro_dinner_start(t_table *table);
+void	coro_init(t_table *table);
+void	coro_destroy(t_table *table);
+void	coro_sleep_until(t_coro *coro, long deadline);
+void	coro_take_fork(t_coro *coro, t_fork *fork);
+void	coro_drop_fork(t_coro *coro, t_fork *fork);
+void	coro_enqueue(t_worker *worker, t_coro *coro);
+void	coro_spawn_all(t_table *table);
+void	coro_after_switch(t_worker *worker, t_coro *coro);
+void	*coro_worker(void *data);
+
+//*** VIRTUAL engine ***
+void	virtual_init(t_table *table);
+void	virtual_destroy(t_table *table);
+void	virtual_dinner_start(t_table *table);
+void	virtual_schedule(t_table *table, long idx, long when, t_vstep step);
+void	virtual_log(t_table *table, t_philo_status status, long idx);
+void	virtual_step(t_table *table, long idx);
+
+//*** PROCESS engine ***
+void	process_init(t_table *table);
+void	process_destroy(t_table *table);
+void	process_dinner_start(t_table *table);
+void	process_rendezvous(t_table *table);
+bool	process_claim_death(t_table *table);
+void	process_post_death(t_table *table, t_event *ev);
+void	semaphore_acquire(t_philo *philo);
+void	semaphore_release(t_philo *philo);
 
 //*** setter and getters, very useful to write DRY code ***
-void	set_bool(t_mtx *mutex, bool *dest, bool value);
-bool	get_bool(t_mtx *mutex, bool *value);
-long	get_long(t_mtx *mutex, long *value);
-void	set_long(t_mtx *mutex, long *dest, long value);
+void	set_bool(t_abool *dest, bool value);
+bool	get_bool(t_abool *value);
+long	get_long(t_along *value);
+void	set_long(t_along *dest, long value);
 bool	simulation_finished(t_table *table);
 
 //*** utils ***
-time_t	gettime(int time_code);
-void	precise_usleep(long usec, t_table *table);
+long	gettime(int time_code);
+void	precise_sleep_until(long deadline, t_table *table);
+void	kernel_sleep_until(long deadline);
+void	hires_slack(t_table *table);
+void	end_sleep_until(t_table *table, long deadline);
+void	cpu_relax(void);
+void	futex_wait(atomic_uint *word, unsigned int val);
+void	futex_wait_until(atomic_uint *word, unsigned int val, long deadline);
+void	futex_wake(atomic_uint *word, int nbr);
+void	calibrate_spin(t_table *table);
 void	clean(t_table *table);
 void	error_exit(const char *error);
 
+//*** --record / --replay, see replay.c ***
+void	replay_init(t_table *table);
+void	replay_turn(t_philo *philo, t_fork *fork);
+void	replay_granted(t_philo *philo, t_fork *fork);
+bool	replay_death_ok(t_table *table, long idx);
+void	replay_death(t_table *table, long idx);
+void	replay_close(t_table *table);
+
+//*** --shm=name, see shm.c ***
+void	shm_init(t_table *table);
+void	shm_event(t_table *table, t_event *ev);
+void	shm_publish(t_table *table, bool force);
+void	shm_close(t_table *table);
+
+//*** thread pool of libphilo, see pool.c ***
+void	dinner_thread_handle(t_table *table, pthread_t *thread,
+			void *(*foo)(void *), void *data, t_opcode opcode);
+void	pool_destroy(t_pool *pool);
+
+//*** --batch=file, see batch.c ***
+int		batch_run(t_options *opt);
+void	batch_load(t_batch *batch);
+void	table_outcome(t_table *table, t_result *res);
+
 //*** write the philo status ***
 void	write_status(t_philo_status status, t_philo *philo, bool debug);
+void	write_death(t_philo *philo, long deadline);
+int		format_event(char *buf, t_event *ev, long start, bool us);
+long	status_aux(t_philo_status status, t_philo *philo);
+
+//*** async logger ***
+void	log_init(t_table *table);
+void	log_push(t_ring *ring, t_event *ev, t_table *table);
+void	log_post_death(t_table *table, t_event *ev);
+void	log_close(t_table *table);
+void	*log_writer(void *data);
+void	log_emit(t_table *table, t_event *ev);
+void	log_flush(t_log *log);
+void	log_destroy(t_table *table);
+void	sort_events(t_event *ev, t_event *tmp, long n);
+
+//*** binary trace, see trace.c ***
+void	trace_init(t_table *table);
+void	trace_start(t_table *table);
+void	trace_record(t_table *table, long seg, t_event *ev);
+void	trace_status(t_philo *philo, t_event *ev);
+void	trace_drops(t_philo *philo, long now);
+void	trace_close(t_table *table);
 
 //*** useful functions to synchro philos ***
 void	wait_all_threads(t_table *table);
-void	increase_long(t_mtx *mutex, long *value);
-bool	all_threads_running(t_mtx *mutex, long *threads, long philo_nbr);
-void    thinking(t_philo *philo, bool pre_simulation);
+void	gate_init(t_gate *gate, long expected);
+void	gate_open(t_table *table);
+void	gate_destroy(t_gate *gate);
+void	increase_long(t_along *value);
+void    thinking(t_philo *philo);
 void    de_synchronize_philos(t_philo *philo);
+long	think_time(t_table *table);
+long	think_until(t_philo *philo, long now);
+long	desync_offset(t_philo *philo);
+long	adaptive_think_until(t_philo *philo, long now);
+void	adaptive_feedback(t_philo *philo, long now);
+long	adaptive_offset(t_philo *philo);
+void	publish_meal(t_philo *philo, long now);
+void	publish_full(t_philo *philo);
+
+void	stop_simulation(t_table *table);
+bool	claim_death(t_table *table);
 
 //*** monitoring for deaths ***
 void	*monitor_dinner(void *data);
+void	monitors_init(t_table *table);
+void	monitors_start(t_table *table);
+void	monitors_join(t_table *table);
+void	monitors_report(t_table *table);
+void	heap_push(t_heap *heap, long when, long philo_idx);
+void	heap_push_tie(t_heap *heap, long when, long philo_idx,
+			unsigned long tie);
+void	heap_pop(t_heap *heap);
+void	heap_update_top(t_heap *heap, long when);
+
+//*** --affinity, see affinity.c ***
+void	affinity_init(t_table *table);
+void	affinity_first_touch(t_table *table);
+void	affinity_apply(t_table *table);
+void	affinity_report(t_table *table);
+
+//*** METRICS=1 instrumentation ***
+void	metrics_thread_awake(t_table *table);
+void	metrics_report(t_table *table);
+void	fairness_init(t_table *table);
+void	fairness_want(t_philo *philo, long now);
+void	fairness_meal(t_philo *philo, long now);
+void	fairness_report(t_table *table);
+void	hist_init(t_hist *hist);
+void	hist_record(t_hist *hist, long value);
+void	hist_merge(t_hist *dst, t_hist *src);
+long	hist_value(long bucket);
+void	hist_report(const char *name, t_hist *hist);
 
 #endif
@@ -0,0 +1,143 @@
+#include "philo.h"
+
+/*
+ * THREAD POOL, libphilo only
+ * A table run through libphilo again and again would
+ * create and join philo_nbr + monitors + writer threads
+ * every time: the kernel work dominates the short dinners.
+ *
+ * The pool keeps them parked on a futex instead:
+ * 	~spawn: an IDLE slot gets the job, READY, wake it.
+ * 		No IDLE slot: one more thread, forever
+ * 	~join: wait for DONE, the slot is IDLE again
+ * 	~pool_destroy: EXIT to everybody, the real joins
+ *
+ * The engines don't know: dinner_thread_handle is
+ * safe_thread_handle when the table has no pool (./philo)
+ *
+ * 💡 The pthread_t of the slot stands for the job, join
+ * 	finds its slot back with pthread_equal 💡
+*/
+
+static void	*pool_worker(void *data)
+{
+	t_pool_slot	*slot;
+	unsigned int	state;
+
+	slot = (t_pool_slot *)data;
+	while (1)
+	{
+		state = atomic_load(&slot->state);
+		while (POOL_IDLE == state || POOL_DONE == state)
+		{
+			futex_wait(&slot->state, state);
+			state = atomic_load(&slot->state);
+		}
+		if (POOL_EXIT == state)
+			return (NULL);
+		slot->fn(slot->arg);
+		atomic_store(&slot->state, POOL_DONE);
+		futex_wake(&slot->state, INT_MAX);
+	}
+}
+
+/*
+ * Double the array of slots, the slots themselves don't move
+*/
+static t_pool_slot	*pool_grow(t_pool *pool)
+{
+	t_pool_slot	**slots;
+	t_pool_slot	*slot;
+
+	if (pool->nbr == pool->cap)
+	{
+		pool->cap = pool->cap * 2 + 8;
+		slots = safe_malloc(pool->cap * sizeof(t_pool_slot *));
+		if (pool->nbr)
+			memcpy(slots, pool->slots, pool->nbr * sizeof(t_pool_slot *));
+		free(pool->slots);
+		pool->slots = slots;
+	}
+	slot = safe_aligned_malloc(sizeof(t_pool_slot));
+	atomic_init(&slot->state, POOL_IDLE);
+	safe_thread_handle(&slot->thread, pool_worker, slot, CREATE);
+	pool->slots[pool->nbr++] = slot;
+	return (slot);
+}
+
+static void	pool_spawn(t_pool *pool, pthread_t *thread, void *(*foo)(void *),
+		void *data)
+{
+	t_pool_slot	*slot;
+	long		i;
+
+	slot = NULL;
+	i = -1;
+	while (!slot && ++i < pool->nbr)
+		if (POOL_IDLE == atomic_load(&pool->slots[i]->state))
+			slot = pool->slots[i];
+	if (!slot)
+		slot = pool_grow(pool);
+	slot->fn = foo;
+	slot->arg = data;
+	atomic_store(&slot->state, POOL_READY);
+	futex_wake(&slot->state, INT_MAX);
+	*thread = slot->thread;
+}
+
+static void	pool_join(t_pool *pool, pthread_t thread)
+{
+	t_pool_slot		*slot;
+	unsigned int	state;
+	long			i;
+
+	i = 0;
+	while (i < pool->nbr && !pthread_equal(pool->slots[i]->thread, thread))
+		i++;
+	if (i == pool->nbr)
+		error_exit("pool: join of a thread the pool doesn't own");
+	slot = pool->slots[i];
+	state = atomic_load(&slot->state);
+	while (POOL_DONE != state)
+	{
+		futex_wait(&slot->state, state);
+		state = atomic_load(&slot->state);
+	}
+	atomic_store(&slot->state, POOL_IDLE);
+}
+
+void	dinner_thread_handle(t_table *table, pthread_t *thread,
+		void *(*foo)(void *), void *data, t_opcode opcode)
+{
+	if (!table->pool)
+		safe_thread_handle(thread, foo, data, opcode);
+	else if (CREATE == opcode)
+		pool_spawn(table->pool, thread, foo, data);
+	else if (JOIN == opcode)
+		pool_join(table->pool, *thread);
+	else
+		error_exit("Wrong opcode for dinner_thread_handle:"
+			" use <CREATE> <JOIN>");
+}
+
+void	pool_destroy(t_pool *pool)
+{
+	long	i;
+
+	i = -1;
+	while (++i < pool->nbr)
+	{
+		atomic_store(&pool->slots[i]->state, POOL_EXIT);
+		futex_wake(&pool->slots[i]->state, INT_MAX);
+	}
+	i = -1;
+	while (++i < pool->nbr)
+	{
+		safe_thread_handle(&pool->slots[i]->thread, NULL, NULL, JOIN);
+		free(pool->slots[i]);
+	}
+	free(pool->slots);
+	pool->slots = NULL;
+	pool->nbr = 0;
+	pool->cap = 0;
+}
@@ -0,0 +1,228 @@
+#include "philo.h"
+#include <sys/prctl.h>
+
+/*
+ * PROCESS engine, --engine=process
+ * One forked process per philo, the same dinner_simulation:
+ * 	~forks: a counting semaphore in shared memory, the pile
+ * 		of the N forks (--strategy=semaphore, strategy_sem.c)
+ * 	~every child has its own monitor thread, watching only
+ * 		its philo, the first death wins across the processes
+ * 	~the log rings live in shared memory: the children push,
+ * 		the writer thread of the parent merges, no lock around
+ * 		printf, same output
+ * 	~the parent sleeps on a semaphore and SIGKILLs all the
+ * 		children as soon as the death is posted
+ *
+ * 💡 Same workload as the THREAD engine: the difference is
+ * 	the cost of the isolation 💡
+*/
+
+static void	sem_take(sem_t *sem)
+{
+	while (sem_wait(sem) && EINTR == errno)
+		;
+}
+
+void	process_init(t_table *table)
+{
+	t_shared	*shared;
+	long		seats;
+
+	shared = mmap(NULL, sizeof(t_shared), PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (MAP_FAILED == shared)
+		error_exit("mmap of the shared memory failed");
+	seats = table->philo_nbr / 2;
+	if (seats < 1)
+		seats = 1;
+	if (sem_init(&shared->forks, 1, table->philo_nbr)
+		|| sem_init(&shared->seats, 1, seats)
+		|| sem_init(&shared->arrived, 1, 0)
+		|| sem_init(&shared->go, 1, 0)
+		|| sem_init(&shared->died, 1, 0))
+		error_exit("sem_init failed");
+	atomic_init(&shared->dead, false);
+	table->proc.shared = shared;
+	table->proc.pids = safe_malloc(table->philo_nbr * sizeof(pid_t));
+}
+
+void	process_destroy(t_table *table)
+{
+	t_shared	*shared;
+
+	shared = table->proc.shared;
+	sem_destroy(&shared->forks);
+	sem_destroy(&shared->seats);
+	sem_destroy(&shared->arrived);
+	sem_destroy(&shared->go);
+	sem_destroy(&shared->died);
+	munmap(shared, sizeof(t_shared));
+	free(table->proc.pids);
+}
+
+/*
+ * Child side of the start gate, called by gate_open:
+ * check in with the parent and take its start time
+*/
+void	process_rendezvous(t_table *table)
+{
+	sem_post(&table->proc.shared->arrived);
+	sem_take(&table->proc.shared->go);
+	table->start_simulation = table->proc.shared->start;
+}
+
+/*
+ * The local claim_death already won,
+ * now against the other processes
+*/
+bool	process_claim_death(t_table *table)
+{
+	bool	expected;
+
+	expected = false;
+	return (atomic_compare_exchange_strong(&table->proc.shared->dead,
+			&expected, true));
+}
+
+/*
+ * The winner hands the DIED event to the parent
+*/
+void	process_post_death(t_table *table, t_event *ev)
+{
+	table->proc.shared->death = *ev;
+	table->proc.shared->posted = gettime(NANOSECOND);
+	sem_post(&table->proc.shared->died);
+}
+
+/*
+ * All the children share the process group of the first one:
+ * ONE kill(2), the kernel signals them all at once.
+ * A loop of kill(2) lets every victim preempt the parent
+*/
+static void	join_group(t_table *table, long idx, pid_t pid)
+{
+	if (0 == idx)
+		setpgid(pid, pid);
+	else
+		setpgid(pid, table->proc.pids[0]);
+}
+
+/*
+ * A child: philo thread + monitor thread of its philo,
+ * the same start gate of the THREAD engine inside.
+ * Never returns: done when full, killed by the parent otherwise.
+ * The parent killed by a signal takes the children with it
+*/
+static void	child(t_table *table, long idx, pid_t parent)
+{
+	t_monitor	mon;
+	t_philo		*philo;
+
+	prctl(PR_SET_PDEATHSIG, SIGKILL);
+	if (getppid() != parent)
+		exit(EXIT_FAILURE);
+	join_group(table, idx, 0);
+	table->proc.self = idx;
+	philo = table->philos + idx;
+	mon.id = 0;
+	mon.lo = idx;
+	mon.hi = idx + 1;
+	mon.table = table;
+	if (METRICS)
+		hist_init(&mon.period);
+	if (1 == table->philo_nbr)
+		safe_thread_handle(&philo->thread_id, lone_philo, philo, CREATE);
+	else
+		safe_thread_handle(&philo->thread_id, dinner_simulation, philo,
+			CREATE);
+	safe_thread_handle(&mon.thread, monitor_dinner, &mon, CREATE);
+	gate_open(table);
+	safe_thread_handle(&philo->thread_id, NULL, NULL, JOIN);
+	stop_simulation(table);
+	safe_thread_handle(&mon.thread, NULL, NULL, JOIN);
+	exit(EXIT_SUCCESS);
+}
+
+/*
+ * Parent thread: waits for every child,
+ * wakes main up if they all ended full
+*/
+static void	*reaper(void *data)
+{
+	t_table	*table;
+	long	i;
+
+	table = (t_table *)data;
+	i = -1;
+	while (++i < table->philo_nbr)
+		while (waitpid(table->proc.pids[i], NULL, 0) < 0 && EINTR == errno)
+			;
+	sem_post(&table->proc.shared->died);
+	return (NULL);
+}
+
+static void	kill_children(t_table *table, long nbr)
+{
+	if (nbr)
+		kill(-table->proc.pids[0], SIGKILL);
+}
+
+/*
+ * 1) fork the children BEFORE any thread of the parent
+ * 2) reaper thread
+ * 3) every child checked in: stamp the start, start the
+ * 		writer (it reads the start), let them go
+ * 4) sleep until a death or the last child
+ * 5) death: SIGKILL everybody, then the writer
+ * 		prints the DIED last, like the other engines
+*/
+void	process_dinner_start(t_table *table)
+{
+	t_shared	*shared;
+	long		i;
+	pid_t		pid;
+	pid_t		parent;
+
+	shared = table->proc.shared;
+	parent = getpid();
+	i = -1;
+	while (++i < table->philo_nbr)
+	{
+		pid = fork();
+		if (pid < 0)
+		{
+			kill_children(table, i);
+			error_exit("fork failed");
+		}
+		if (0 == pid)
+			child(table, i, parent);
+		table->proc.pids[i] = pid;
+		join_group(table, i, pid);
+	}
+	safe_thread_handle(&table->proc.reaper, reaper, table, CREATE);
+	i = -1;
+	while (++i < table->philo_nbr)
+		sem_take(&shared->arrived);
+	shared->start = gettime(NANOSECOND);
+	table->start_simulation = shared->start;
+	trace_start(table);
+	safe_thread_handle(&table->log.writer, log_writer, table, CREATE);
+	if (METRICS)
+		table->metrics.release = gettime(MICROSECOND);
+	i = -1;
+	while (++i < table->philo_nbr)
+		sem_post(&shared->go);
+	sem_take(&shared->died);
+	if (get_bool(&shared->dead))
+	{
+		table->metrics.kill = gettime(NANOSECOND) - shared->posted;
+		table->metrics.died_at = shared->posted;
+		kill_children(table, table->philo_nbr);
+		log_post_death(table, &shared->death);
+	}
+	stop_simulation(table);
+	safe_thread_handle(&table->proc.reaper, NULL, NULL, JOIN);
+	log_close(table);
+	safe_thread_handle(&table->log.writer, NULL, NULL, JOIN);
+}
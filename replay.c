@@ -0,0 +1,363 @@
+#include "philo.h"
+#include <fcntl.h>
+
+/*
+ * RECORD / REPLAY, --record=file --replay=file, THREAD engine
+ *
+ * A tight dinner dies once every few hundred runs: who gets
+ * a fork first is whoever wins the lock, a different race
+ * every run. The dinner is only its fork grants:
+ *
+ * 	~--record: every fork logs who got it, 1 bit per grant
+ * 		(only 2 philos share a fork), and the monitor logs
+ * 		the death it declared. Written at the end
+ * 	~--replay: before locking a fork the philo waits his
+ * 		turn in the recorded order, a futex on the grant
+ * 		index of the fork. Same grants, same meals, same death
+ *
+ * The monitor of a replay only declares the recorded death:
+ * a deadline missed because the replay runs a few us late
+ * is looked at again later, and counted (deferred).
+ *
+ * 💡 When it's his turn the philo pays 1 atomic load: the
+ * 	waits are the ones the recording already had 💡
+ *
+ * Only --strategy=hierarchy: waiter seats and backoff
+ * try-locks decide outside the grants
+*/
+
+/*
+ * 0: the philo at the index of the fork, 1: the one before
+*/
+static int	side_of(t_philo *philo, t_fork *fork)
+{
+	return (philo->id - 1 != fork->fork_id);
+}
+
+static int	bit_at(t_grants *g, long k)
+{
+	return ((g->bits[k / 8] >> (k % 8)) & 1);
+}
+
+static bool	read_exact(int fd, void *buf, long len)
+{
+	ssize_t	ret;
+	long	done;
+
+	done = 0;
+	while (done < len)
+	{
+		ret = read(fd, (char *)buf + done, len - done);
+		if (ret < 0 && EINTR == errno)
+			continue ;
+		if (ret <= 0)
+			return (false);
+		done += ret;
+	}
+	return (true);
+}
+
+static bool	same_dinner(t_replay_head *a, t_replay_head *b)
+{
+	return (!strncmp(a->strategy, b->strategy, sizeof(a->strategy))
+		&& a->philo_nbr == b->philo_nbr && a->time_to_die == b->time_to_die
+		&& a->time_to_eat == b->time_to_eat
+		&& a->time_to_sleep == b->time_to_sleep && a->meals == b->meals);
+}
+
+/*
+ * Replay: how many grants of the recording are his
+*/
+static void	count_left(t_table *table, t_replay *r)
+{
+	long	i;
+	long	k;
+	long	idx;
+
+	r->left = safe_malloc(table->philo_nbr * sizeof(t_along));
+	i = -1;
+	while (++i < table->philo_nbr)
+		atomic_init(r->left + i, 0);
+	i = -1;
+	while (++i < table->philo_nbr)
+	{
+		k = -1;
+		while (++k < r->forks[i].nbr)
+		{
+			idx = i;
+			if (bit_at(r->forks + i, k))
+				idx = (i + table->philo_nbr - 1) % table->philo_nbr;
+			atomic_fetch_add(r->left + idx, 1);
+		}
+	}
+}
+
+/*
+ * 🚨 Other arguments, other dinner: the grants
+ * 	would not even fit, refused 🚨
+*/
+static void	replay_load(t_table *table, t_replay *r)
+{
+	t_replay_head	head;
+	int64_t			nbr;
+	long			i;
+	int				fd;
+
+	fd = open(table->opt.replay, O_RDONLY);
+	if (fd < 0 || !read_exact(fd, &head, sizeof(head))
+		|| memcmp(head.magic, REPLAY_MAGIC, sizeof(head.magic))
+		|| REPLAY_VERSION != head.version)
+		error_exit("--replay: not a --record file");
+	if (!same_dinner(&head, &r->head))
+		error_exit("--replay: recorded with other arguments or strategy");
+	r->head = head;
+	i = -1;
+	while (++i < table->philo_nbr)
+	{
+		if (!read_exact(fd, &nbr, sizeof(nbr)))
+			error_exit("--replay: truncated file");
+		r->forks[i].nbr = nbr;
+	}
+	i = -1;
+	while (++i < table->philo_nbr)
+	{
+		r->forks[i].cap = (r->forks[i].nbr + 7) / 8;
+		r->forks[i].bits = safe_malloc(r->forks[i].cap + 1);
+		if (!read_exact(fd, r->forks[i].bits, r->forks[i].cap))
+			error_exit("--replay: truncated file");
+	}
+	close(fd);
+	count_left(table, r);
+}
+
+/*
+ * After the forks, before the threads
+*/
+void	replay_init(t_table *table)
+{
+	t_replay	*r;
+	long		i;
+
+	r = &table->replay;
+	r->forks = NULL;
+	r->left = NULL;
+	r->died_at = -1;
+	atomic_init(&r->deferred, 0);
+	if (NULL == table->opt.record && NULL == table->opt.replay)
+		return ;
+	r->forks = safe_aligned_malloc(table->philo_nbr * sizeof(t_grants));
+	memset(r->forks, 0, table->philo_nbr * sizeof(t_grants));
+	i = -1;
+	while (++i < table->philo_nbr)
+		atomic_init(&r->forks[i].next, 0);
+	memset(&r->head, 0, sizeof(t_replay_head));
+	memcpy(r->head.magic, REPLAY_MAGIC, sizeof(r->head.magic));
+	r->head.version = REPLAY_VERSION;
+	snprintf(r->head.strategy, sizeof(r->head.strategy), "%s",
+		table->opt.strategy->name);
+	r->head.philo_nbr = table->philo_nbr;
+	r->head.time_to_die = table->time_to_die;
+	r->head.time_to_eat = table->time_to_eat;
+	r->head.time_to_sleep = table->time_to_sleep;
+	r->head.meals = table->nbr_limit_meals;
+	r->head.dead = -1;
+	if (table->opt.replay)
+		replay_load(table, r);
+}
+
+/*
+ * Replay, before the lock: wait until the next grant
+ * of the fork is mine. Past the end of the recording
+ * (the dinner is over) the lock is free for all again
+*/
+void	replay_turn(t_philo *philo, t_fork *fork)
+{
+	t_grants		*g;
+	unsigned int	next;
+	int				side;
+
+	if (NULL == philo->table->opt.replay)
+		return ;
+	g = philo->table->replay.forks + fork->fork_id;
+	side = side_of(philo, fork);
+	while (!simulation_finished(philo->table))
+	{
+		next = atomic_load(&g->next);
+		if (next >= g->nbr || side == bit_at(g, next))
+			return ;
+		futex_wait_until(&g->next, next,
+			gettime(NANOSECOND) + REPLAY_POLL_NS);
+	}
+}
+
+/*
+ * After the lock, the holder is the only one here:
+ * record appends his bit, replay moves the turn on.
+ * 🚨 Not recorded after the end: a grant the dead philo
+ * 	gets on his way out would feed him in the replay,
+ * 	before the death 🚨
+*/
+void	replay_granted(t_philo *philo, t_fork *fork)
+{
+	t_grants	*g;
+	uint8_t		*bits;
+
+	if (NULL == philo->table->replay.forks)
+		return ;
+	g = philo->table->replay.forks + fork->fork_id;
+	if (philo->table->opt.replay)
+	{
+		if (get_long(philo->table->replay.left + philo->id - 1) > 0)
+			atomic_fetch_sub(philo->table->replay.left + philo->id - 1, 1);
+		atomic_fetch_add(&g->next, 1);
+		futex_wake(&g->next, INT_MAX);
+		return ;
+	}
+	if (simulation_finished(philo->table))
+		return ;
+	if (g->nbr == g->cap * 8)
+	{
+		bits = safe_malloc(g->cap * 2 + 64);
+		if (g->cap)
+			memcpy(bits, g->bits, g->cap);
+		free(g->bits);
+		g->bits = bits;
+		g->cap = g->cap * 2 + 64;
+	}
+	g->bits[g->nbr / 8] &= ~(1 << (g->nbr % 8));
+	g->bits[g->nbr / 8] |= side_of(philo, fork) << (g->nbr % 8);
+	g->nbr++;
+}
+
+/*
+ * Monitor, a passed deadline: in a replay only the
+ * recorded death is a death, once the dead philo got
+ * every grant the recording gave him
+*/
+bool	replay_death_ok(t_table *table, long idx)
+{
+	t_replay	*r;
+
+	r = &table->replay;
+	if (NULL == table->opt.replay)
+		return (true);
+	if (idx == r->head.dead && 0 == get_long(r->left + idx))
+		return (true);
+	atomic_fetch_add(&r->deferred, 1);
+	return (false);
+}
+
+/*
+ * The monitor that won claim_death, nobody else writes it
+*/
+void	replay_death(t_table *table, long idx)
+{
+	t_replay	*r;
+	long		now;
+
+	r = &table->replay;
+	if (NULL == r->forks)
+		return ;
+	now = gettime(NANOSECOND) - table->start_simulation;
+	if (table->opt.replay)
+	{
+		r->died_at = now;
+		return ;
+	}
+	r->head.dead = idx;
+	r->head.died_at = now;
+}
+
+static void	write_all(int fd, const void *buf, long len)
+{
+	ssize_t	ret;
+	long	done;
+
+	done = 0;
+	while (done < len)
+	{
+		ret = write(fd, (const char *)buf + done, len - done);
+		if (ret < 0 && EINTR == errno)
+			continue ;
+		if (ret <= 0)
+			error_exit("--record: write failed");
+		done += ret;
+	}
+}
+
+static void	record_write(t_table *table, t_replay *r)
+{
+	int64_t	nbr;
+	long	i;
+	int		fd;
+
+	fd = open(table->opt.record, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		error_exit("Cannot create the --record file");
+	write_all(fd, &r->head, sizeof(t_replay_head));
+	i = -1;
+	while (++i < table->philo_nbr)
+	{
+		nbr = r->forks[i].nbr;
+		write_all(fd, &nbr, sizeof(nbr));
+	}
+	i = -1;
+	while (++i < table->philo_nbr)
+		write_all(fd, r->forks[i].bits, (r->forks[i].nbr + 7) / 8);
+	close(fd);
+}
+
+/*
+ * Replay: how close to the recording, on stderr.
+ * Grants after the death are free for all, not counted
+*/
+static void	replay_report(t_table *table, t_replay *r)
+{
+	long	grants;
+	long	recorded;
+	long	next;
+	long	i;
+
+	grants = 0;
+	recorded = 0;
+	i = -1;
+	while (++i < table->philo_nbr)
+	{
+		next = atomic_load(&r->forks[i].next);
+		if (next > r->forks[i].nbr)
+			next = r->forks[i].nbr;
+		grants += next;
+		recorded += r->forks[i].nbr;
+	}
+	fprintf(stderr, "[replay] %ld / %ld grants replayed", grants, recorded);
+	if (-1 == r->head.dead)
+		fprintf(stderr, ", nobody died in the recording");
+	else
+		fprintf(stderr, ", %ld died at %.3f ms (recorded %.3f ms)",
+			r->head.dead + 1, r->died_at / 1e6, r->head.died_at / 1e6);
+	fprintf(stderr, ", %ld death checks deferred\n",
+		atomic_load(&r->deferred));
+}
+
+/*
+ * After the joins, from clean
+*/
+void	replay_close(t_table *table)
+{
+	t_replay	*r;
+	long		i;
+
+	r = &table->replay;
+	if (NULL == r->forks)
+		return ;
+	if (table->opt.record)
+		record_write(table, r);
+	else
+		replay_report(table, r);
+	i = -1;
+	while (++i < table->philo_nbr)
+		free(r->forks[i].bits);
+	free(r->forks);
+	free(r->left);
+	r->forks = NULL;
+}
@@ -24,6 +24,20 @@ void	*safe_malloc(size_t bytes)
 	return (ret);
 }
 
+/*
+ * Same, CACHE_LINE aligned: arrays of
+ * aligned structs (philos, forks, deadlines)
+*/
+void	*safe_aligned_malloc(size_t bytes)
+{
+	void	*ret;
+
+	ret = NULL;
+	if (posix_memalign(&ret, CACHE_LINE, bytes))
+		error_exit("Error with the malloc");
+	return (ret);
+}
+
 /*
  *   HANDLING ERRORS
  *   If successful, all the mutex and thread functions 
@@ -96,6 +110,41 @@ void	safe_mutex_handle(t_mtx *mutex, t_opcode opcode)
 			"use <LOCK> <UNLOCK> <INIT> <DESTROY>");
 }
 
+/*
+ * CONDITION VARIABLES
+ * init destroy broadcast, same errors of the mutexes
+ *
+ * 💡 timed waits use CLOCK_MONOTONIC, like gettime 💡
+*/
+static int	cond_init_monotonic(t_cond *cond)
+{
+	pthread_condattr_t	attr;
+	int					ret;
+
+	ret = pthread_condattr_init(&attr);
+	if (0 == ret)
+		ret = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	if (0 == ret)
+		ret = pthread_cond_init(cond, &attr);
+	pthread_condattr_destroy(&attr);
+	return (ret);
+}
+
+void	safe_cond_handle(t_cond *cond, t_opcode opcode)
+{
+	if (INIT == opcode)
+		handle_mutex_error(cond_init_monotonic(cond), opcode);
+	else if (DESTROY == opcode)
+		handle_mutex_error(pthread_cond_destroy(cond), opcode);
+	else if (BROADCAST == opcode)
+		handle_mutex_error(pthread_cond_broadcast(cond), opcode);
+	else if (SIGNAL == opcode)
+		handle_mutex_error(pthread_cond_signal(cond), opcode);
+	else
+		error_exit("Wrong opcode for cond_handle:"
+			"use <INIT> <DESTROY> <BROADCAST> <SIGNAL>");
+}
+
 /*
  * One function to handle threads
  * create join detach
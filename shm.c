@@ -0,0 +1,240 @@
+#include "philo.h"
+#include <fcntl.h>
+
+/*
+ * LIVE STATS PAGE, --shm=name
+ *
+ * A run without a meal limit is a stdout flood: to see how
+ * it goes, ./philo publishes a page in POSIX shared memory,
+ * /dev/shm/name, and tools/philo_top reads it live.
+ *
+ * The philos don't know about it: the log writer already
+ * sees every line in order, it keeps the counters
+ * (meals, last meal, state, fork owners) in private copies,
+ * then every SHM_PUBLISH_NS copies what changed to the page
+ * under a seqlock:
+ * 	~seq odd: copy in progress
+ * 	~the viewer copies the page, then checks that seq is the
+ * 		same even number it read before: else torn, again
+ *
+ * 💡 Zero cost in dinner_simulation: no lock, no store, the
+ * 	events are the ones the log already had 💡
+ *
+ * One table, one page: no --batch, no libphilo.
+ * Unlinked at the end, a viewer attached keeps the last page
+*/
+
+static const char	*g_engines[] = {"thread", "coro", "virtual", "process"};
+
+/*
+ * "name" or "/name", the shm_open form is "/name"
+*/
+static void	shm_name(t_shm *shm, const char *name)
+{
+	if ('/' == name[0])
+		name++;
+	if ('\0' == name[0] || strchr(name, '/')
+		|| strlen(name) + 2 > SHM_NAME_MAX)
+		error_exit("--shm=name: no '/', at most 62 characters");
+	snprintf(shm->name, SHM_NAME_MAX, "/%s", name);
+}
+
+static void	shm_layout(t_table *table, t_shm *shm)
+{
+	long	i;
+
+	memset(&shm->stats, 0, sizeof(t_shm_stats));
+	snprintf(shm->stats.engine, sizeof(shm->stats.engine), "%s",
+		g_engines[table->opt.engine]);
+	snprintf(shm->stats.strategy, sizeof(shm->stats.strategy), "%s",
+		table->opt.strategy->name);
+	shm->stats.time_to_die = table->time_to_die;
+	shm->stats.time_to_eat = table->time_to_eat;
+	shm->stats.time_to_sleep = table->time_to_sleep;
+	shm->stats.meals_limit = table->nbr_limit_meals;
+	shm->stats.real = (ENGINE_VIRTUAL != table->opt.engine);
+	shm->stats.pile = !strcmp(table->opt.strategy->name, "semaphore");
+	i = -1;
+	while (++i < table->philo_nbr)
+	{
+		shm->philos[i].meals = 0;
+		shm->philos[i].last_meal = 0;
+		shm->philos[i].state = -1;
+		shm->philos[i].owner = 0;
+		shm->is_dirty[i] = 0;
+	}
+	memcpy(shm->page_stats, &shm->stats, sizeof(t_shm_stats));
+	memcpy(shm->page_philos, shm->philos,
+		table->philo_nbr * sizeof(t_shm_philo));
+}
+
+/*
+ * After the philos. The head is written once,
+ * the magic last: a viewer attaching now waits for it
+*/
+void	shm_init(t_table *table)
+{
+	t_shm	*shm;
+	int		fd;
+
+	shm = &table->shm;
+	shm->map = NULL;
+	if (NULL == table->opt.shm)
+		return ;
+	shm_name(shm, table->opt.shm);
+	shm->len = sizeof(t_shm_head) + sizeof(t_shm_stats)
+		+ table->philo_nbr * sizeof(t_shm_philo);
+	fd = shm_open(shm->name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0 || ftruncate(fd, shm->len))
+		error_exit("Cannot create the --shm page");
+	shm->map = mmap(NULL, shm->len, PROT_READ | PROT_WRITE, MAP_SHARED,
+			fd, 0);
+	close(fd);
+	if (MAP_FAILED == shm->map)
+		error_exit("mmap of the --shm page failed");
+	shm->head = shm->map;
+	shm->page_stats = (t_shm_stats *)(shm->head + 1);
+	shm->page_philos = (t_shm_philo *)(shm->page_stats + 1);
+	shm->philos = safe_malloc(table->philo_nbr * sizeof(t_shm_philo));
+	shm->dirty = safe_malloc(table->philo_nbr * sizeof(long));
+	shm->is_dirty = safe_malloc(table->philo_nbr);
+	shm->dirty_nbr = 0;
+	shm->next = 0;
+	shm->head->version = SHM_VERSION;
+	shm->head->philo_nbr = table->philo_nbr;
+	shm->head->pid = getpid();
+	atomic_init(&shm->head->seq, 0);
+	shm_layout(table, shm);
+	atomic_thread_fence(memory_order_release);
+	memcpy(shm->head->magic, SHM_MAGIC, sizeof(shm->head->magic));
+}
+
+static void	shm_dirty(t_shm *shm, long idx)
+{
+	if (shm->is_dirty[idx])
+		return ;
+	shm->is_dirty[idx] = 1;
+	shm->dirty[shm->dirty_nbr++] = idx;
+}
+
+/*
+ * The fork at the index of the philo is his, and the one
+ * of the philo after him. Eating done (SLEEPING): both are
+ * back on the table, unless a neighbour's take was logged first
+*/
+static void	shm_forks(t_table *table, t_shm *shm, t_event *ev, long idx)
+{
+	long	other;
+
+	if (shm->stats.pile)
+		return ;
+	if (TAKE_FIRST_FORK == ev->status || TAKE_SECOND_FORK == ev->status)
+	{
+		shm->philos[ev->aux].owner = ev->philo_id;
+		shm_dirty(shm, ev->aux);
+	}
+	else if (SLEEPING == ev->status)
+	{
+		other = (idx + 1) % table->philo_nbr;
+		if (shm->philos[idx].owner == ev->philo_id)
+			shm->philos[idx].owner = 0;
+		if (shm->philos[other].owner == ev->philo_id)
+		{
+			shm->philos[other].owner = 0;
+			shm_dirty(shm, other);
+		}
+	}
+}
+
+/*
+ * Log writer (or the VIRTUAL loop), every line, in order:
+ * private copies only, nothing shared is written here
+*/
+void	shm_event(t_table *table, t_event *ev)
+{
+	t_shm	*shm;
+	long	idx;
+
+	shm = &table->shm;
+	if (NULL == shm->map || ev->status > DIED)
+		return ;
+	idx = ev->philo_id - 1;
+	shm->stats.start = table->start_simulation;
+	shm->stats.now = ev->time - table->start_simulation;
+	shm->stats.events++;
+	shm->philos[idx].state = ev->status;
+	if (EATING == ev->status)
+	{
+		shm->philos[idx].meals++;
+		shm->philos[idx].last_meal = shm->stats.now;
+		shm->stats.meals_total++;
+	}
+	else if (DIED == ev->status)
+		shm->stats.dead = ev->philo_id;
+	shm_dirty(shm, idx);
+	shm_forks(table, shm, ev, idx);
+}
+
+/*
+ * Seqlock, 1 writer: seq odd, copy, seq even.
+ * The release fence keeps the copy after the odd seq,
+ * the release store keeps it before the even one.
+ * Only the philos changed since the last time are copied:
+ * 1M coroutines don't cost 24 MB every SHM_PUBLISH_NS
+*/
+void	shm_publish(t_table *table, bool force)
+{
+	t_shm	*shm;
+	long	seq;
+	long	now;
+	long	i;
+
+	shm = &table->shm;
+	if (NULL == shm->map)
+		return ;
+	now = gettime(NANOSECOND);
+	if (!force && now < shm->next)
+		return ;
+	shm->next = now + SHM_PUBLISH_NS;
+	seq = atomic_load_explicit(&shm->head->seq, memory_order_relaxed);
+	atomic_store_explicit(&shm->head->seq, seq + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	memcpy(shm->page_stats, &shm->stats, sizeof(t_shm_stats));
+	i = -1;
+	while (++i < shm->dirty_nbr)
+	{
+		shm->page_philos[shm->dirty[i]] = shm->philos[shm->dirty[i]];
+		shm->is_dirty[shm->dirty[i]] = 0;
+	}
+	shm->dirty_nbr = 0;
+	atomic_store_explicit(&shm->head->seq, seq + 2, memory_order_release);
+}
+
+/*
+ * From clean, after the joins: the last page says ended.
+ * A full philo has no SLEEPING line, his forks are
+ * given back here
+*/
+void	shm_close(t_table *table)
+{
+	t_shm	*shm;
+	long	i;
+
+	shm = &table->shm;
+	if (NULL == shm->map)
+		return ;
+	i = -1;
+	while (++i < table->philo_nbr)
+	{
+		shm->philos[i].owner = 0;
+		shm_dirty(shm, i);
+	}
+	shm->stats.ended = 1;
+	shm_publish(table, true);
+	munmap(shm->map, shm->len);
+	shm_unlink(shm->name);
+	free(shm->philos);
+	free(shm->dirty);
+	free(shm->is_dirty);
+	shm->map = NULL;
+}
@@ -0,0 +1,109 @@
+#include "philo.h"
+
+/*
+ * FORK STRATEGIES, --strategy=name
+ *
+ * eat() does not know how the forks are taken:
+ * table->opt.strategy->acquire / release
+ *
+ * 	~hierarchy	(default) first/second fork from assign_forks,
+ * 				the odd/even order breaks the cycle
+ * 	~waiter		arbiter: max N-1 philos at the table,
+ * 				a cycle needs N
+ * 	~chandy		Chandy-Misra: clean/dirty forks handed over
+ * 				on request between neighbours
+ * 	~backoff	try lock both, on failure put back and
+ * 				retry after a random growing pause
+ * 	~semaphore	pile of forks in shared memory, the
+ * 				PROCESS engine one (strategy_sem.c)
+ *
+ * 💡 Only hierarchy runs on every engine. The others block
+ * 	on pthread primitives: --engine=thread only.
+ * 	chandy waits on the fork mutex itself, the only one
+ * 	without a --lock choice 💡
+*/
+static const t_strategy	g_strategies[] = {
+{"hierarchy", NULL, hierarchy_acquire, hierarchy_release, NULL},
+{"waiter", waiter_init, waiter_acquire, waiter_release, waiter_destroy},
+{"chandy", chandy_init, chandy_acquire, chandy_release, chandy_destroy},
+{"backoff", NULL, backoff_acquire, backoff_release, NULL},
+{"semaphore", NULL, semaphore_acquire, semaphore_release, NULL},
+};
+
+const t_strategy	*strategy_find(const char *name)
+{
+	size_t	i;
+
+	i = 0;
+	while (i < sizeof(g_strategies) / sizeof(*g_strategies))
+	{
+		if (!strcmp(name, g_strategies[i].name))
+			return (g_strategies + i);
+		i++;
+	}
+	return (NULL);
+}
+
+/*
+ * The original eat(): first fork, then second
+*/
+void	hierarchy_acquire(t_philo *philo)
+{
+	take_fork(philo, philo->first_fork);
+	write_status(TAKE_FIRST_FORK, philo, DEBUG_MODE);
+	take_fork(philo, philo->second_fork);
+	write_status(TAKE_SECOND_FORK, philo, DEBUG_MODE);
+}
+
+void	hierarchy_release(t_philo *philo)
+{
+	drop_fork(philo, philo->first_fork);
+	drop_fork(philo, philo->second_fork);
+}
+
+/*
+ * Random pause in [max / 2, max), cheap per thread LCG,
+ * so 2 neighbours do not retry in lockstep
+*/
+static long	jitter(t_philo *philo, long max)
+{
+	unsigned long	seed;
+
+	seed = (unsigned long)philo->id * 2654435761UL
+		^ (unsigned long)gettime(NANOSECOND);
+	seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+	return (max / 2 + (long)((seed >> 33) % (unsigned long)(max / 2 + 1)));
+}
+
+/*
+ * TRY LOCK WITH BACKOFF
+ * Never waits while holding a fork: no hold-and-wait,
+ * no deadlock. The pause doubles up to BACKOFF_MAX_NS
+*/
+void	backoff_acquire(t_philo *philo)
+{
+	long	pause;
+
+	pause = BACKOFF_MIN_NS;
+	while (1)
+	{
+		if (try_fork(philo, philo->first_fork))
+		{
+			if (try_fork(philo, philo->second_fork))
+				break ;
+			drop_fork(philo, philo->first_fork);
+		}
+		end_sleep_until(philo->table,
+			gettime(NANOSECOND) + jitter(philo, pause));
+		if (pause < BACKOFF_MAX_NS)
+			pause *= 2;
+	}
+	write_status(TAKE_FIRST_FORK, philo, DEBUG_MODE);
+	write_status(TAKE_SECOND_FORK, philo, DEBUG_MODE);
+}
+
+void	backoff_release(t_philo *philo)
+{
+	drop_fork(philo, philo->first_fork);
+	drop_fork(philo, philo->second_fork);
+}
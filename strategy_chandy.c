@@ -0,0 +1,165 @@
+#include "philo.h"
+
+/*
+ * CHANDY-MISRA strategy
+ *
+ * Every fork always belongs to one of its 2 philos, clean or dirty:
+ * 	~at start the lower index philo holds it, dirty
+ * 		(acyclic precedence graph, nobody waits in a circle)
+ * 	~eating makes a fork dirty
+ * 	~a dirty fork not in use is given to the neighbour who asks,
+ * 		cleaned. A clean fork is kept until its holder ate
+ * 	~the request is the message: requested = true, then wait on
+ * 		the fork cond until the holder hands it over
+ *
+ * The holder may be sleeping when the request arrives: the
+ * requester applies the rule on his behalf, under the fork
+ * mutex, same result as an answer to the message.
+ *
+ * Hungry philos beat the ones that just ate:
+ * no starvation, no global order, no arbiter.
+*/
+static long	neighbour(t_table *table, long fork_id, long me)
+{
+	if (fork_id == me)
+		return ((fork_id - 1 + table->philo_nbr) % table->philo_nbr);
+	return (fork_id);
+}
+
+void	chandy_init(t_table *table)
+{
+	long		i;
+	long		other;
+	t_cm_fork	*cm;
+
+	table->strat.cm = safe_malloc(table->philo_nbr * sizeof(t_cm_fork));
+	i = -1;
+	while (++i < table->philo_nbr)
+	{
+		cm = table->strat.cm + i;
+		safe_cond_handle(&cm->handed, INIT);
+		other = neighbour(table, i, i);
+		cm->holder = i;
+		if (other < i)
+			cm->holder = other;
+		cm->dirty = true;
+		cm->in_use = false;
+		cm->requested = false;
+	}
+}
+
+void	chandy_destroy(t_table *table)
+{
+	long	i;
+
+	i = -1;
+	while (++i < table->philo_nbr)
+		safe_cond_handle(&table->strat.cm[i].handed, DESTROY);
+	free(table->strat.cm);
+}
+
+/*
+ * Get one fork: mine already, a dirty one nobody eats with,
+ * or ask and wait for the hand over
+*/
+static void	get_fork(t_table *table, t_fork *fork, long me)
+{
+	t_cm_fork	*cm;
+
+	cm = table->strat.cm + fork->fork_id;
+	safe_mutex_handle(&fork->fork, LOCK);
+	while (cm->holder != me)
+	{
+		if (cm->dirty && !cm->in_use)
+		{
+			cm->holder = me;
+			cm->dirty = false;
+			cm->requested = false;
+		}
+		else
+		{
+			cm->requested = true;
+			pthread_cond_wait(&cm->handed, &fork->fork);
+		}
+	}
+	safe_mutex_handle(&fork->fork, UNLOCK);
+}
+
+/*
+ * Both forks still mine? (a dirty one could have been
+ * given away while I waited for the other). Then they are
+ * in use until release. Mutexes in fork_id order
+*/
+static bool	claim(t_table *table, t_philo *philo, long me)
+{
+	t_fork	*low;
+	t_fork	*high;
+	bool	mine;
+
+	low = philo->first_fork;
+	high = philo->second_fork;
+	if (low->fork_id > high->fork_id)
+	{
+		low = philo->second_fork;
+		high = philo->first_fork;
+	}
+	safe_mutex_handle(&low->fork, LOCK);
+	safe_mutex_handle(&high->fork, LOCK);
+	mine = (table->strat.cm[low->fork_id].holder == me
+			&& table->strat.cm[high->fork_id].holder == me);
+	if (mine)
+	{
+		table->strat.cm[low->fork_id].in_use = true;
+		table->strat.cm[high->fork_id].in_use = true;
+	}
+	safe_mutex_handle(&high->fork, UNLOCK);
+	safe_mutex_handle(&low->fork, UNLOCK);
+	return (mine);
+}
+
+void	chandy_acquire(t_philo *philo)
+{
+	long	me;
+
+	me = philo->id - 1;
+	while (1)
+	{
+		get_fork(philo->table, philo->first_fork, me);
+		get_fork(philo->table, philo->second_fork, me);
+		if (claim(philo->table, philo, me))
+			break ;
+	}
+	write_status(TAKE_FIRST_FORK, philo, DEBUG_MODE);
+	write_status(TAKE_SECOND_FORK, philo, DEBUG_MODE);
+}
+
+/*
+ * Forks become dirty, a pending request
+ * gets the fork right now, cleaned
+*/
+void	chandy_release(t_philo *philo)
+{
+	t_fork		*forks[2];
+	t_cm_fork	*cm;
+	int			i;
+
+	forks[0] = philo->first_fork;
+	forks[1] = philo->second_fork;
+	i = -1;
+	while (++i < 2)
+	{
+		cm = philo->table->strat.cm + forks[i]->fork_id;
+		safe_mutex_handle(&forks[i]->fork, LOCK);
+		cm->in_use = false;
+		cm->dirty = true;
+		if (cm->requested)
+		{
+			cm->holder = neighbour(philo->table, forks[i]->fork_id,
+					philo->id - 1);
+			cm->dirty = false;
+			cm->requested = false;
+			safe_cond_handle(&cm->handed, BROADCAST);
+		}
+		safe_mutex_handle(&forks[i]->fork, UNLOCK);
+	}
+}
@@ -0,0 +1,37 @@
+#include "philo.h"
+
+/*
+ * SEMAPHORE STRATEGY, --engine=process only
+ * The forks are a pile: a counting semaphore of N in
+ * shared memory, any 2 forks will do.
+ * N philos holding 1 fork each would wait forever:
+ * the seats semaphore lets only N / 2 philos try at once,
+ * 2 forks for each of them are always there
+*/
+static void	take(sem_t *sem)
+{
+	while (sem_wait(sem) && EINTR == errno)
+		;
+}
+
+void	semaphore_acquire(t_philo *philo)
+{
+	t_shared	*shared;
+
+	shared = philo->table->proc.shared;
+	take(&shared->seats);
+	take(&shared->forks);
+	write_status(TAKE_FIRST_FORK, philo, DEBUG_MODE);
+	take(&shared->forks);
+	write_status(TAKE_SECOND_FORK, philo, DEBUG_MODE);
+}
+
+void	semaphore_release(t_philo *philo)
+{
+	t_shared	*shared;
+
+	shared = philo->table->proc.shared;
+	sem_post(&shared->forks);
+	sem_post(&shared->forks);
+	sem_post(&shared->seats);
+}
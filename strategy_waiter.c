@@ -0,0 +1,68 @@
+#include "philo.h"
+
+/*
+ * WAITER (arbiter) strategy
+ *
+ * A philo asks the waiter for a seat before touching a fork.
+ * Only N-1 seats: with N philos a circular wait would need
+ * all of them holding one fork, impossible with N-1.
+ *
+ * 💡 Plain left -> right would be deadlock free, but tsan
+ * 	(DEBUG_MODE) only sees the lock order cycle and reports it:
+ * 	forks are taken lower index first, no odd/even trick 💡
+*/
+void	waiter_init(t_table *table)
+{
+	safe_mutex_handle(&table->strat.seats_mutex, INIT);
+	safe_cond_handle(&table->strat.seats_cond, INIT);
+	table->strat.seats = table->philo_nbr - 1;
+}
+
+void	waiter_destroy(t_table *table)
+{
+	safe_mutex_handle(&table->strat.seats_mutex, DESTROY);
+	safe_cond_handle(&table->strat.seats_cond, DESTROY);
+}
+
+/*
+ * forks[i] and forks[i + 1], lower index first:
+ * only the last philo takes forks[0] before forks[n - 1]
+*/
+void	waiter_acquire(t_philo *philo)
+{
+	t_strat_data	*s;
+	t_fork			*left;
+	t_fork			*right;
+
+	s = &philo->table->strat;
+	safe_mutex_handle(&s->seats_mutex, LOCK);
+	while (0 == s->seats)
+		pthread_cond_wait(&s->seats_cond, &s->seats_mutex);
+	s->seats--;
+	safe_mutex_handle(&s->seats_mutex, UNLOCK);
+	left = philo->table->forks + philo->id - 1;
+	right = philo->table->forks + philo->id % philo->table->philo_nbr;
+	if (left > right)
+	{
+		left = right;
+		right = philo->table->forks + philo->id - 1;
+	}
+	take_fork(philo, left);
+	write_status(TAKE_FIRST_FORK, philo, DEBUG_MODE);
+	take_fork(philo, right);
+	write_status(TAKE_SECOND_FORK, philo, DEBUG_MODE);
+}
+
+void	waiter_release(t_philo *philo)
+{
+	t_strat_data	*s;
+
+	s = &philo->table->strat;
+	drop_fork(philo, philo->table->forks + philo->id - 1);
+	drop_fork(philo, philo->table->forks + philo->id
+		% philo->table->philo_nbr);
+	safe_mutex_handle(&s->seats_mutex, LOCK);
+	s->seats++;
+	safe_cond_handle(&s->seats_cond, SIGNAL);
+	safe_mutex_handle(&s->seats_mutex, UNLOCK);
+}
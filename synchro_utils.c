@@ -1,64 +1,143 @@
 #include "philo.h"
+#include <sched.h>
 
 /*
- * Wait for all threads to be 
- * ready, busy waiting (spinlock)
+ * Thread safe counter increment, meals_counter
  *
- * I use a getter function to read with no race 
- * condition the variable
+ * 💡 fetch_add is a single atomic read-modify-write,
+ * 	ACQ_REL so it orders like a lock + unlock pair 💡
 */
-void	wait_all_threads(t_table *table)
+void	increase_long(t_along *value)
 {
-	while (!get_bool(&table->table_mutex, &table->all_threads_ready))
-		;
+	atomic_fetch_add_explicit(value, 1, memory_order_acq_rel);
 }
 
 /*
- * Simple function to synchro monitoring thread and philos
-	 * Monitor thread can start only when all threads are ready
- * When a philo enters the loop, increases the threads count
+ * Synchronize the philos to minimize
+ * resource contention and 
+ * improve fairness
+ * 1) if even, just 30ms (half the min value 60ms)
+ * 		after the start, half a meal with --hires
+ * 2) if odd, start by thinking (silently)
+ *
+ * desync_offset is the delay from the start,
+ * the VIRTUAL engine schedules it as first event.
+ * --think=adaptive starts the ideal rotation instead
 */
-void	increase_long(t_mtx *mutex, long *value)
-{	
-	safe_mutex_handle(mutex, LOCK);
-	(*value)++;
-	safe_mutex_handle(mutex, UNLOCK);
+long	desync_offset(t_philo *philo)
+{
+	if (THINK_ADAPTIVE == philo->table->opt.think)
+		return (adaptive_offset(philo));
+	if (philo->table->philo_nbr % 2 == 0)
+	{
+		if (philo->id % 2 == 0 && philo->table->opt.hires)
+			return (philo->table->time_to_eat / 2);
+		if (philo->id % 2 == 0)
+			return (30 * NSEC_PER_MSEC);
+	}
+	else if (philo->id % 2)
+		return (think_time(philo->table));
+	return (0);
 }
 
+void	de_synchronize_philos(t_philo *philo)
+{
+	long	offset;
+
+	offset = desync_offset(philo);
+	if (offset)
+		philo_sleep_until(philo, philo->table->start_simulation + offset);
+}	
+
 /*
- * Monitor waits all threads are running the 
- * simulation before searching deaths
+ * Every timed sleep of the dinner waits on end_word:
+ * ONE futex wake and they are all out, in microseconds,
+ * instead of finishing their t_eat / t_sleep
 */
-bool	all_threads_running(t_mtx *mutex, long *threads,
-		long philo_nbr)
+static void	wake_sleepers(t_table *table)
 {
-	bool	ret;
-
-	ret = false;
-	safe_mutex_handle(mutex, LOCK);
-	if (*threads == philo_nbr)
-		ret = true;
-	safe_mutex_handle(mutex, UNLOCK);
-	return (ret);
+	atomic_store(&table->end_word, 1);
+	futex_wake(&table->end_word, INT_MAX);
 }
 
 /*
- * Synchronize the philos to minimize
- * resource contention and 
- * improve fairness
- * 1) if even, just 30ms (half the min value 60ms)
- * 2) if odd, start by thinking
+ * Sleep until deadline (ABSOLUTE, NANOSECOND), or until
+ * the end of the simulation, whichever comes first.
+ * After the end just yield: the caller is on its way out
+ *
+ * 💡 The word is checked by the kernel before sleeping:
+ * 	a wake_sleepers between our check and our wait is
+ * 	never lost 💡
 */
-void	de_synchronize_philos(t_philo *philo)
+void	end_sleep_until(t_table *table, long deadline)
 {
-	if (philo->table->philo_nbr % 2 == 0)
-	{
-		if (philo->id % 2 == 0)
-			precise_usleep(3e4, philo->table);
-	}
+	if (atomic_load(&table->end_word))
+		sched_yield();
 	else
-	{
-		if (philo->id % 2)
-			thinking(philo, true);
-	}
-}	
+		futex_wait_until(&table->end_word, 0, deadline);
+}
+
+/*
+ * Turn ON end_simulation and wake up the monitor
+ * if it's sleeping until a deadline.
+ * Under monitor_mutex so the wake up can't be lost
+ * between its check and its wait.
+ * Then the sleeping philos and workers
+*/
+void	stop_simulation(t_table *table)
+{
+	safe_mutex_handle(&table->monitor_mutex, LOCK);
+	set_bool(&table->end_simulation, true);
+	safe_cond_handle(&table->monitor_cond, BROADCAST);
+	safe_mutex_handle(&table->monitor_mutex, UNLOCK);
+	wake_sleepers(table);
+}
+
+/*
+ * FIRST DEATH WINS
+ * Two monitors (or two processes) can see a death in the same instant:
+ * only the one flipping end_simulation false -> true
+ * writes DIED, the others just leave.
+ * Same wake up of stop_simulation for the other monitors,
+ * the winner also wakes the sleepers.
+ * seq_cst: the busy rings of write_status count on it
+*/
+bool	claim_death(t_table *table)
+{
+	bool	expected;
+	bool	won;
+
+	expected = false;
+	safe_mutex_handle(&table->monitor_mutex, LOCK);
+	won = atomic_compare_exchange_strong_explicit(&table->end_simulation,
+			&expected, true, memory_order_seq_cst, memory_order_seq_cst);
+	if (won && ENGINE_PROCESS == table->opt.engine)
+		won = process_claim_death(table);
+	safe_cond_handle(&table->monitor_cond, BROADCAST);
+	safe_mutex_handle(&table->monitor_mutex, UNLOCK);
+	if (won && METRICS)
+		table->metrics.died_at = gettime(NANOSECOND);
+	if (won)
+		wake_sleepers(table);
+	return (won);
+}
+
+/*
+ * A meal starts: the philo own last_meal_time and
+ * the SoA deadline the monitor scans
+*/
+void	publish_meal(t_philo *philo, long now)
+{
+	set_long(&philo->last_meal_time, now);
+	set_long(philo->table->deadlines + philo->id - 1,
+		now + philo->table->time_to_die);
+}
+
+/*
+ * Full philos never die, deadline out of reach
+*/
+void	publish_full(t_philo *philo)
+{
+	set_bool(&philo->full, true);
+	set_long(philo->table->deadlines + philo->id - 1, LONG_MAX);
+}
@@ -0,0 +1,171 @@
+#include "philo.h"
+
+/*
+ * ADAPTIVE THINKING, --think=adaptive, opt-in:
+ * the default stays --think=fixed (dinner.c)
+ * No magic factor: the philo aims at the ideal rotation,
+ * one meal every period(), and corrects itself at every meal.
+ *
+ * 	~plan:		last meal + period - lead
+ * 	~neighbours:	one of them is eating -> think until
+ * 				he drops the fork, no point in holding
+ * 				the other one meanwhile.
+ * 				One of them is hungrier (older meal) ->
+ * 				let him eat first
+ * 	~cap:		never think away more than half of the
+ * 				margin time_to_die - period. Even N: never
+ * 				later than --think=fixed, no thinking at all,
+ * 				the margin is the scheduler's (200 410 200 200)
+ * 	~lead:		learnt at every meal from the fork wait
+ * 				(came too early) and from the forks left
+ * 				idle before coming (came too late)
+ *
+ * 💡 Same code for every engine, the VIRTUAL one
+ * 	included: the neighbours are read, never waited for 💡
+*/
+
+/*
+ * Best sustainable time between 2 meals:
+ * N / 2 philos eat at once, and nobody eats
+ * more often than t_eat + t_sleep
+*/
+static long	period(t_table *table)
+{
+	long	ideal;
+
+	ideal = table->time_to_eat * table->philo_nbr / (table->philo_nbr / 2);
+	if (ideal < table->time_to_eat + table->time_to_sleep)
+		ideal = table->time_to_eat + table->time_to_sleep;
+	return (ideal);
+}
+
+static t_philo	*neighbour(t_philo *philo, long side)
+{
+	long	nbr;
+
+	nbr = philo->table->philo_nbr;
+	return (philo->table->philos + (philo->id - 1 + side + nbr) % nbr);
+}
+
+/*
+ * When the neighbour will not need our common fork anymore:
+ * 	~eating now -> the end of his meal
+ * 	~hungrier -> the end of his next meal,
+ * 		he is sleeping or thinking: when he stops
+ * 	~else he can wait, 0
+*/
+static long	leave_fork_at(t_philo *philo, t_philo *other, long now)
+{
+	t_table	*table;
+	long	meal;
+	long	ready;
+
+	table = philo->table;
+	meal = get_long(&other->last_meal_time);
+	if (meal + table->time_to_eat > now)
+		return (meal + table->time_to_eat);
+	if (get_bool(&other->full)
+		|| meal >= get_long(&philo->last_meal_time))
+		return (0);
+	ready = get_long(&other->think_end);
+	if (ready < meal + table->time_to_eat + table->time_to_sleep)
+		ready = meal + table->time_to_eat + table->time_to_sleep;
+	if (ready < now)
+		ready = now;
+	return (ready + table->time_to_eat);
+}
+
+long	adaptive_think_until(t_philo *philo, long now)
+{
+	t_table	*table;
+	long	last;
+	long	end;
+	long	cap;
+	long	side;
+
+	table = philo->table;
+	last = get_long(&philo->last_meal_time);
+	end = last + period(table) - philo->think_lead;
+	side = -1;
+	while (side <= 1)
+	{
+		if (leave_fork_at(philo, neighbour(philo, side), now) > end)
+			end = leave_fork_at(philo, neighbour(philo, side), now);
+		side += 2;
+	}
+	cap = last + table->time_to_eat + table->time_to_sleep;
+	if (table->philo_nbr % 2 && table->time_to_die > period(table))
+		cap = last + (table->time_to_die + period(table)) / 2;
+	if (end > cap)
+		end = cap;
+	if (end < now)
+		end = now;
+	set_long(&philo->think_end, end);
+	return (end);
+}
+
+/*
+ * Forks in hand, BEFORE publish_meal.
+ * wait:	now - end of the thinking, came too early
+ * idle:	both forks were already free when the
+ * 		thinking ended, came too late.
+ * The lead moves by a quarter of the error, between
+ * the ideal slot (0) and no thinking at all
+*/
+void	adaptive_feedback(t_philo *philo, long now)
+{
+	t_table	*table;
+	long	want;
+	long	freed;
+	long	side;
+	long	idle;
+
+	table = philo->table;
+	want = get_long(&philo->think_end);
+	if (want < get_long(&philo->last_meal_time))
+		return ;
+	freed = 0;
+	side = -1;
+	while (side <= 1)
+	{
+		idle = get_long(&neighbour(philo, side)->last_meal_time)
+			+ table->time_to_eat;
+		if (idle > freed)
+			freed = idle;
+		side += 2;
+	}
+	idle = want - freed;
+	if (idle < 0)
+		idle = 0;
+	philo->think_lead += (idle - (now - want)) / 4;
+	if (philo->think_lead > period(table) - table->time_to_eat
+		- table->time_to_sleep)
+		philo->think_lead = period(table) - table->time_to_eat
+			- table->time_to_sleep;
+	if (philo->think_lead < 0)
+		philo->think_lead = 0;
+}
+
+/*
+ * First meal of the rotation:
+ * 	~even N: odd ids at 0, even ids when they are done
+ * 	~odd N = 2k + 1: a wave, one philo every t_eat / k,
+ * 		even ids first, then odd ids.
+ * 		Neighbours are always t_eat apart or more,
+ * 		nobody waits, already the ideal period
+*/
+long	adaptive_offset(t_philo *philo)
+{
+	t_table	*table;
+	long	step;
+
+	table = philo->table;
+	if (table->philo_nbr < 2)
+		return (0);
+	if (table->philo_nbr % 2 == 0)
+		return ((philo->id % 2 == 0) * table->time_to_eat);
+	step = table->time_to_eat / (table->philo_nbr / 2);
+	if (philo->id % 2 == 0)
+		return ((philo->id / 2 - 1) * step);
+	return ((table->philo_nbr / 2 + philo->id / 2) * step);
+}
@@ -0,0 +1,323 @@
+#include "../philo.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+
+/*
+ * PHILO TOP, live viewer of ./philo --shm=name
+ *
+ * ./philo_top [--refresh=ms] [--rows=N] [--once] name
+ * 	~--refresh=ms:	redraw period, default 500
+ * 	~--rows=N:		hungriest philos listed, default 20
+ * 	~--once:		one snapshot on stdout, no screen control
+ *
+ * The page is mapped read only: the viewer can't slow the
+ * dinner down, it only copies. A copy is good when seq was
+ * the same even number before and after it (seqlock, see
+ * shm.c), else the writer was in the middle: copy again.
+ *
+ * Stops when the dinner ended or its process is gone.
+*/
+
+#define TOP_REFRESH_MS 500
+#define TOP_ROWS 20
+#define TOP_TRIES 1000
+
+static const char	*g_states[] = {"eating", "sleeping", "thinking",
+	"1 fork", "2 forks", "died"};
+
+typedef struct s_row
+{
+	long	idx;
+	long	since;
+}			t_row;
+
+/*
+ * ~stats, philos: the last good copy
+ * ~prev_*: the copy before, for the meals/s of the refresh
+ * ~torn: copies thrown away, the writer was copying
+*/
+typedef struct s_top
+{
+	t_shm_head	*head;
+	size_t		len;
+	t_shm_stats	stats;
+	t_shm_philo	*philos;
+	t_row		*rows;
+	long		prev_meals;
+	long		prev_now;
+	long		torn;
+	long		refresh;
+	long		rows_max;
+	bool		once;
+}				t_top;
+
+static long	now_ns(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000000000L + ts.tv_nsec);
+}
+
+static void	nap_ns(long ns)
+{
+	struct timespec	ts;
+
+	ts.tv_sec = ns / 1000000000L;
+	ts.tv_nsec = ns % 1000000000L;
+	nanosleep(&ts, NULL);
+}
+
+/*
+ * mmap the page read only, NULL if it is not a philo page.
+ * The magic is written last: a page just created gets
+ * a few tries
+*/
+static t_shm_head	*attach(const char *name, size_t *len)
+{
+	struct stat	st;
+	t_shm_head	*head;
+	int			fd;
+	int			tries;
+
+	fd = shm_open(name, O_RDONLY, 0);
+	if (fd < 0 || fstat(fd, &st)
+		|| st.st_size < (off_t)(sizeof(t_shm_head) + sizeof(t_shm_stats)))
+	{
+		fprintf(stderr, "%s: no stats page, is ./philo --shm=%s running?\n",
+			name, name + 1);
+		return (NULL);
+	}
+	*len = st.st_size;
+	head = mmap(NULL, *len, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (MAP_FAILED == head)
+		return (NULL);
+	tries = 0;
+	while (memcmp(head->magic, SHM_MAGIC, 8) && ++tries < 100)
+		nap_ns(10000000L);
+	if (memcmp(head->magic, SHM_MAGIC, 8) || SHM_VERSION != head->version
+		|| *len < sizeof(t_shm_head) + sizeof(t_shm_stats)
+		+ head->philo_nbr * sizeof(t_shm_philo))
+	{
+		fprintf(stderr, "%s: not a philo stats page\n", name);
+		munmap(head, *len);
+		return (NULL);
+	}
+	return (head);
+}
+
+/*
+ * Seqlock reader: the acquire load orders the copy after
+ * the first seq, the acquire fence orders it before the
+ * second one. After TOP_TRIES the last copy is shown anyway
+*/
+static void	snapshot(t_top *top)
+{
+	t_shm_stats	*stats;
+	long		before;
+	long		tries;
+
+	stats = (t_shm_stats *)(top->head + 1);
+	tries = 0;
+	while (tries++ < TOP_TRIES)
+	{
+		before = atomic_load_explicit(&top->head->seq, memory_order_acquire);
+		if (before & 1)
+		{
+			top->torn++;
+			nap_ns(100000L);
+			continue ;
+		}
+		memcpy(&top->stats, stats, sizeof(t_shm_stats));
+		memcpy(top->philos, stats + 1, top->head->philo_nbr
+			* sizeof(t_shm_philo));
+		atomic_thread_fence(memory_order_acquire);
+		if (before == atomic_load_explicit(&top->head->seq,
+				memory_order_relaxed))
+			return ;
+		top->torn++;
+	}
+}
+
+/*
+ * Since the start: the viewer clock while the dinner runs
+ * (same CLOCK_MONOTONIC), the last event once it ended
+ * or with virtual time
+*/
+static long	elapsed(t_top *top)
+{
+	if (!top->stats.real || top->stats.ended)
+		return (top->stats.now);
+	return (now_ns() - top->stats.start);
+}
+
+static bool	is_full(t_top *top, t_shm_philo *p)
+{
+	return (top->stats.meals_limit > 0 && p->meals >= top->stats.meals_limit
+		&& DIED != p->state);
+}
+
+static const char	*state_name(t_top *top, t_shm_philo *p)
+{
+	if (is_full(top, p))
+		return ("full");
+	if (p->state < EATING || p->state > DIED)
+		return ("-");
+	return (g_states[p->state]);
+}
+
+/*
+ * Hungriest first, the full ones don't starve: last
+*/
+static int	by_hunger(const void *a, const void *b)
+{
+	const t_row	*x;
+	const t_row	*y;
+
+	x = a;
+	y = b;
+	if (x->since != y->since)
+		return ((x->since < y->since) - (x->since > y->since));
+	return ((x->idx > y->idx) - (x->idx < y->idx));
+}
+
+static void	print_head(t_top *top, const char *name, long now)
+{
+	t_shm_stats	*s;
+	double		rate;
+
+	s = &top->stats;
+	rate = 0;
+	if (now > top->prev_now && top->prev_now >= 0)
+		rate = (s->meals_total - top->prev_meals) * 1e9
+			/ (now - top->prev_now);
+	printf("philo_top %s  pid %ld  %s engine, %s", name,
+		(long)top->head->pid, s->engine, s->strategy);
+	if (s->dead)
+		printf("  -> %ld died at %.3f ms", (long)s->dead, s->now / 1e6);
+	else if (s->ended)
+		printf("  -> ended, nobody died");
+	printf("\n%ld philos  t_die %.3f  t_eat %.3f  t_sleep %.3f ms",
+		(long)top->head->philo_nbr, s->time_to_die / 1e6,
+		s->time_to_eat / 1e6, s->time_to_sleep / 1e6);
+	if (s->meals_limit > 0)
+		printf("  %ld meals", (long)s->meals_limit);
+	printf("  elapsed %.3f s\n", now / 1e9);
+	printf("meals %ld  %.1f/s now  %.1f/s avg  %ld lines  %ld torn reads\n\n",
+		(long)s->meals_total, rate, s->meals_total * 1e9 / (now + (now <= 0)),
+		(long)s->events, top->torn);
+}
+
+static void	print_rows(t_top *top, long now)
+{
+	t_shm_philo	*p;
+	long		i;
+
+	i = -1;
+	while (++i < top->head->philo_nbr)
+	{
+		top->rows[i].idx = i;
+		top->rows[i].since = now - top->philos[i].last_meal;
+		if (is_full(top, top->philos + i))
+			top->rows[i].since = LONG_MIN + i;
+	}
+	qsort(top->rows, top->head->philo_nbr, sizeof(t_row), by_hunger);
+	printf("%8s  %-9s %8s %12s %12s %8s\n", "philo", "state", "meals",
+		"since meal", "margin", "fork by");
+	i = -1;
+	while (++i < top->head->philo_nbr && i < top->rows_max)
+	{
+		p = top->philos + top->rows[i].idx;
+		printf("%8ld  %-9s %8ld %12.3f %12.3f ", top->rows[i].idx + 1,
+			state_name(top, p), (long)p->meals,
+			(now - p->last_meal) / 1e6,
+			(p->last_meal + top->stats.time_to_die - now) / 1e6);
+		if (top->stats.pile)
+			printf("%8s\n", "pile");
+		else if (0 == p->owner)
+			printf("%8s\n", "-");
+		else
+			printf("%8ld\n", (long)p->owner);
+	}
+}
+
+static void	draw(t_top *top, const char *name)
+{
+	long	now;
+
+	snapshot(top);
+	if (!top->once)
+		printf("\033[H\033[2J");
+	if (0 == top->stats.start && top->stats.real)
+	{
+		printf("philo_top %s: waiting for the start\n", name);
+		fflush(stdout);
+		return ;
+	}
+	now = elapsed(top);
+	print_head(top, name, now);
+	print_rows(top, now);
+	fflush(stdout);
+	top->prev_meals = top->stats.meals_total;
+	top->prev_now = now;
+}
+
+static bool	parse_args(t_top *top, int ac, char **av)
+{
+	int	i;
+
+	top->refresh = TOP_REFRESH_MS;
+	top->rows_max = TOP_ROWS;
+	top->once = false;
+	i = 0;
+	while (++i < ac - 1)
+	{
+		if (!strncmp(av[i], "--refresh=", 10))
+			top->refresh = atol(av[i] + 10);
+		else if (!strncmp(av[i], "--rows=", 7))
+			top->rows_max = atol(av[i] + 7);
+		else if (!strcmp(av[i], "--once"))
+			top->once = true;
+		else
+			return (false);
+	}
+	return (ac >= 2 && top->refresh > 0 && top->rows_max >= 0
+		&& strncmp(av[ac - 1], "--", 2));
+}
+
+int	main(int ac, char **av)
+{
+	t_top	top;
+	char	name[SHM_NAME_MAX];
+
+	if (!parse_args(&top, ac, av))
+	{
+		fprintf(stderr, "usage: %s [--refresh=ms] [--rows=N] [--once] name\n",
+			av[0]);
+		return (EXIT_FAILURE);
+	}
+	snprintf(name, SHM_NAME_MAX, "/%s", av[ac - 1] + ('/' == av[ac - 1][0]));
+	top.head = attach(name, &top.len);
+	if (NULL == top.head)
+		return (EXIT_FAILURE);
+	top.philos = malloc(top.head->philo_nbr * sizeof(t_shm_philo));
+	top.rows = malloc(top.head->philo_nbr * sizeof(t_row));
+	if (NULL == top.philos || NULL == top.rows)
+		return (EXIT_FAILURE);
+	top.prev_now = -1;
+	top.torn = 0;
+	draw(&top, name);
+	while (!top.once && !top.stats.ended && 0 == kill(top.head->pid, 0))
+	{
+		nap_ns(top.refresh * 1000000L);
+		draw(&top, name);
+	}
+	if (!top.once && !top.stats.ended)
+		fprintf(stderr, "philo_top: pid %ld is gone, stale page: rm /dev/shm%s\n",
+			(long)top.head->pid, name);
+	free(top.philos);
+	free(top.rows);
+	munmap(top.head, top.len);
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,502 @@
+#include "../philo.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+
+/*
+ * PHILO TRACE, offline decoder of ./philo --trace=file
+ *
+ * ./philo_trace [--text|--text-us|--forks|--chrome] file
+ * 	~--text:	the standard log, byte for byte (format.c), default
+ * 	~--text-us:	the same with the --stamp=us timestamps, 12.345
+ * 	~--forks:	per fork utilisation + a timeline, one row per fork
+ * 	~--chrome:	trace-event JSON, open it in chrome://tracing
+ * 		or ui.perfetto.dev
+ *
+ * All the segments are merged in time order. A wrapped
+ * segment lost its oldest records: the output starts at the
+ * oldest instant every segment still covers, said on stderr.
+ * It ends at the DIED, like the log of ./philo.
+*/
+
+#define TIMELINE_BINS 64
+
+typedef struct s_item
+{
+	t_trace_rec	rec;
+	long		seq;
+}				t_item;
+
+typedef struct s_dump
+{
+	t_trace_head	*head;
+	t_item			*items;
+	long			nbr;
+	long			from;
+	long			to;
+}				t_dump;
+
+static int	by_time(const void *a, const void *b)
+{
+	const t_item	*x;
+	const t_item	*y;
+
+	x = a;
+	y = b;
+	if (x->rec.time != y->rec.time)
+		return ((x->rec.time > y->rec.time) - (x->rec.time < y->rec.time));
+	return ((x->seq > y->seq) - (x->seq < y->seq));
+}
+
+static int	status_of(t_trace_rec *rec)
+{
+	return (rec->kind & 0xff);
+}
+
+static long	aux_of(t_trace_rec *rec)
+{
+	return (rec->kind >> 8);
+}
+
+/*
+ * The log writer prints nothing stamped after the DIED,
+ * and the DIED last (emit_until). The trace keeps what the
+ * philos recorded until the end really reached them:
+ * --engine=process children record until the SIGKILL
+*/
+static void	cut_at_death(t_dump *d)
+{
+	t_item	death;
+	long	kept;
+	long	i;
+
+	i = 0;
+	while (i < d->nbr && DIED != status_of(&d->items[i].rec))
+		i++;
+	if (i == d->nbr)
+		return ;
+	death = d->items[i];
+	kept = i;
+	while (++i < d->nbr)
+		if (d->items[i].rec.time <= death.rec.time
+			&& DIED != status_of(&d->items[i].rec))
+			d->items[kept++] = d->items[i];
+	d->items[kept++] = death;
+	d->nbr = kept;
+}
+
+/*
+ * Copy the live records of every segment, oldest first,
+ * and find the window all the segments cover
+*/
+static void	collect(t_dump *d, t_trace_seg *segs, t_trace_rec *recs)
+{
+	long	s;
+	long	n;
+	long	live;
+
+	d->items = malloc(sizeof(t_item) * 1);
+	d->nbr = 0;
+	d->from = LONG_MIN;
+	s = -1;
+	while (++s < d->head->seg_nbr)
+	{
+		live = segs[s].count;
+		if (live > segs[s].capacity)
+			live = segs[s].capacity;
+		d->items = realloc(d->items, sizeof(t_item) * (d->nbr + live + 1));
+		if (NULL == d->items)
+			exit(EXIT_FAILURE);
+		n = segs[s].count - live - 1;
+		while (++n < segs[s].count)
+		{
+			d->items[d->nbr].rec = recs[segs[s].first
+				+ (n & (segs[s].capacity - 1))];
+			d->items[d->nbr++].seq = n;
+		}
+		if (segs[s].count > segs[s].capacity
+			&& d->items[d->nbr - live].rec.time > d->from)
+			d->from = d->items[d->nbr - live].rec.time;
+	}
+	qsort(d->items, d->nbr, sizeof(t_item), by_time);
+	cut_at_death(d);
+	d->to = d->head->start;
+	if (d->nbr)
+		d->to = d->items[d->nbr - 1].rec.time;
+	if (LONG_MIN == d->from)
+		d->from = d->head->start;
+	else
+		fprintf(stderr, "philo_trace: wrapped, showing from %ld ms\n",
+			(d->from - d->head->start) / NSEC_PER_MSEC);
+}
+
+static void	dump_text(t_dump *d, bool us)
+{
+	char	buf[LOG_LINE_MAX];
+	t_event	ev;
+	long	i;
+	int		len;
+
+	i = -1;
+	while (++i < d->nbr)
+	{
+		if (d->items[i].rec.time < d->from
+			|| DROP_FORK == status_of(&d->items[i].rec))
+			continue ;
+		ev.time = d->items[i].rec.time;
+		ev.aux = aux_of(&d->items[i].rec);
+		ev.philo_id = d->items[i].rec.philo_id;
+		ev.status = status_of(&d->items[i].rec);
+		ev.debug = false;
+		len = format_event(buf, &ev, d->head->start, us);
+		fwrite(buf, 1, len, stdout);
+	}
+}
+
+/*
+ * Add the busy interval [a, b) to the bins of the fork
+*/
+static void	add_busy(double *bins, t_dump *d, long a, long b)
+{
+	double	width;
+	long	bin;
+	long	end;
+
+	width = (double)(d->to - d->from) / TIMELINE_BINS;
+	if (width <= 0)
+		return ;
+	while (a < b)
+	{
+		bin = (a - d->from) / width;
+		if (bin >= TIMELINE_BINS)
+			bin = TIMELINE_BINS - 1;
+		end = d->from + (bin + 1) * width;
+		if (end > b || bin == TIMELINE_BINS - 1)
+			end = b;
+		if (end <= a)
+			end = a + 1;
+		bins[bin] += (double)(end - a) / width;
+		a = end;
+	}
+}
+
+static void	print_fork(long f, double *bins)
+{
+	static const char	shade[] = " .:-=+*#%@";
+	double				total;
+	long				level;
+	long				i;
+
+	total = 0;
+	i = -1;
+	while (++i < TIMELINE_BINS)
+		total += bins[i];
+	printf("%-6ld %5.1f%% |", f, 100.0 * total / TIMELINE_BINS);
+	i = -1;
+	while (++i < TIMELINE_BINS)
+	{
+		level = bins[i] * 9.999;
+		if (level > 9)
+			level = 9;
+		putchar(shade[level]);
+	}
+	printf("|\n");
+}
+
+static bool	is_take(t_trace_rec *rec)
+{
+	return (TAKE_FIRST_FORK == status_of(rec)
+		|| TAKE_SECOND_FORK == status_of(rec));
+}
+
+/*
+ * Taken on the first TAKE_* of the fork, free on its DROP_FORK.
+ * Timeline: one char per bin, " .:-=+*#%@" by utilisation
+*/
+static void	dump_forks(t_dump *d)
+{
+	long	*taken;
+	double	*bins;
+	long	i;
+	long	f;
+
+	taken = malloc(sizeof(long) * d->head->philo_nbr);
+	bins = calloc(d->head->philo_nbr * TIMELINE_BINS, sizeof(double));
+	if (NULL == taken || NULL == bins)
+		exit(EXIT_FAILURE);
+	f = -1;
+	while (++f < d->head->philo_nbr)
+		taken[f] = -1;
+	i = -1;
+	while (++i < d->nbr)
+	{
+		f = aux_of(&d->items[i].rec);
+		if (d->items[i].rec.time < d->from || f >= d->head->philo_nbr)
+			continue ;
+		if (is_take(&d->items[i].rec) && -1 == taken[f])
+			taken[f] = d->items[i].rec.time;
+		else if (DROP_FORK == status_of(&d->items[i].rec) && -1 != taken[f])
+		{
+			add_busy(bins + f * TIMELINE_BINS, d, taken[f],
+				d->items[i].rec.time);
+			taken[f] = -1;
+		}
+	}
+	printf("fork    busy  |%ld ms .. %ld ms|\n",
+		(d->from - d->head->start) / NSEC_PER_MSEC,
+		(d->to - d->head->start) / NSEC_PER_MSEC);
+	f = -1;
+	while (++f < d->head->philo_nbr)
+	{
+		if (-1 != taken[f])
+			add_busy(bins + f * TIMELINE_BINS, d, taken[f], d->to);
+		print_fork(f, bins + f * TIMELINE_BINS);
+	}
+	free(taken);
+	free(bins);
+}
+
+/*
+ * Chrome trace-event: one complete ("X") event per state
+ * of a philo (pid 1, tid = philo id) and per fork hold
+ * (pid 2, tid = fork id + 1), the death is an instant
+*/
+static void	chrome_sep(void)
+{
+	static bool	first = true;
+
+	if (!first)
+		putchar(',');
+	first = false;
+	putchar('\n');
+}
+
+static void	chrome_span(t_dump *d, const char *name, long pid_tid[2],
+		long ab[2])
+{
+	chrome_sep();
+	printf("{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%ld,\"tid\":%ld,"
+		"\"ts\":%.3f,\"dur\":%.3f}", name, pid_tid[0], pid_tid[1],
+		(ab[0] - d->head->start) / 1000.0, (ab[1] - ab[0]) / 1000.0);
+}
+
+/*
+ * taken: [since, philo] per fork
+*/
+static void	chrome_fork(t_dump *d, long f, long *taken, long now)
+{
+	char	name[32];
+	long	pid_tid[2];
+	long	ab[2];
+
+	if (-1 == taken[2 * f])
+		return ;
+	snprintf(name, sizeof(name), "held by %ld", taken[2 * f + 1]);
+	pid_tid[0] = 2;
+	pid_tid[1] = f + 1;
+	ab[0] = taken[2 * f];
+	ab[1] = now;
+	chrome_span(d, name, pid_tid, ab);
+	taken[2 * f] = -1;
+}
+
+/*
+ * state: [status, since] per philo id, the open
+ * state ends now
+*/
+static void	chrome_close(t_dump *d, long p, long *state, long now)
+{
+	static const char	*names[] = {"eating", "sleeping", "thinking"};
+	long				pid_tid[2];
+	long				ab[2];
+
+	if (-1 == state[2 * p])
+		return ;
+	pid_tid[0] = 1;
+	pid_tid[1] = p;
+	ab[0] = state[2 * p + 1];
+	ab[1] = now;
+	chrome_span(d, names[state[2 * p]], pid_tid, ab);
+	state[2 * p] = -1;
+}
+
+static void	chrome_state(t_dump *d, long p, long *state, t_trace_rec *rec)
+{
+	chrome_close(d, p, state, rec->time);
+	if (DIED != status_of(rec))
+	{
+		state[2 * p] = status_of(rec);
+		state[2 * p + 1] = rec->time;
+		return ;
+	}
+	chrome_sep();
+	printf("{\"name\":\"died\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,"
+		"\"tid\":%ld,\"ts\":%.3f}", p,
+		(rec->time - d->head->start) / 1000.0);
+}
+
+static void	chrome_meta(long pid, const char *name)
+{
+	chrome_sep();
+	printf("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%ld,"
+		"\"args\":{\"name\":\"%s\"}}", pid, name);
+}
+
+static void	dump_chrome(t_dump *d, long *state, long *taken)
+{
+	long		i;
+	t_trace_rec	*rec;
+
+	printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	chrome_meta(1, "philos");
+	chrome_meta(2, "forks");
+	i = -1;
+	while (++i < d->nbr)
+	{
+		rec = &d->items[i].rec;
+		if (rec->time < d->from || rec->philo_id < 1
+			|| rec->philo_id > d->head->philo_nbr
+			|| aux_of(rec) >= d->head->philo_nbr)
+			continue ;
+		if (is_take(rec) && -1 == taken[2 * aux_of(rec)])
+		{
+			taken[2 * aux_of(rec)] = rec->time;
+			taken[2 * aux_of(rec) + 1] = rec->philo_id;
+		}
+		else if (DROP_FORK == status_of(rec))
+			chrome_fork(d, aux_of(rec), taken, rec->time);
+		else if (!is_take(rec))
+			chrome_state(d, rec->philo_id, state, rec);
+	}
+	i = -1;
+	while (++i < d->head->philo_nbr)
+	{
+		chrome_fork(d, i, taken, d->to);
+		chrome_close(d, i + 1, state, d->to);
+	}
+	printf("\n]}\n");
+}
+
+static void	chrome(t_dump *d)
+{
+	long	*state;
+	long	*taken;
+	long	i;
+
+	state = malloc(sizeof(long) * 2 * (d->head->philo_nbr + 1));
+	taken = malloc(sizeof(long) * 2 * d->head->philo_nbr);
+	if (NULL == state || NULL == taken)
+		exit(EXIT_FAILURE);
+	i = -1;
+	while (++i < d->head->philo_nbr)
+	{
+		state[2 * (i + 1)] = -1;
+		taken[2 * i] = -1;
+	}
+	dump_chrome(d, state, taken);
+	free(state);
+	free(taken);
+}
+
+/*
+ * Every count of the head and the segments comes from the
+ * file: a truncated or damaged trace must not make collect
+ * read past the mapping
+ * ~the segments fit in the file, the records area follows
+ * ~capacity a power of 2, the index is a mask
+ * ~every segment inside the records area
+*/
+static bool	valid_layout(t_trace_head *head, size_t len)
+{
+	t_trace_seg	*segs;
+	size_t		records;
+	int64_t		s;
+
+	if (head->seg_nbr < 1 || head->philo_nbr < 1
+		|| (size_t)head->seg_nbr > (len - sizeof(t_trace_head))
+		/ sizeof(t_trace_seg))
+		return (false);
+	segs = (t_trace_seg *)(head + 1);
+	records = (len - sizeof(t_trace_head) - head->seg_nbr
+			* sizeof(t_trace_seg)) / sizeof(t_trace_rec);
+	s = -1;
+	while (++s < head->seg_nbr)
+	{
+		if (segs[s].capacity < 1 || segs[s].count < 0 || segs[s].first < 0
+			|| (segs[s].capacity & (segs[s].capacity - 1))
+			|| (size_t)segs[s].first > records
+			|| (size_t)segs[s].capacity > records - segs[s].first)
+			return (false);
+	}
+	return (true);
+}
+
+/*
+ * mmap the whole file, NULL if it is not a trace
+ * or its layout does not fit in it
+*/
+static void	*load(const char *path, size_t *len)
+{
+	struct stat	st;
+	void		*map;
+	int			fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st)
+		|| st.st_size < (off_t)sizeof(t_trace_head))
+	{
+		perror(path);
+		return (NULL);
+	}
+	*len = st.st_size;
+	map = mmap(NULL, *len, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (MAP_FAILED == map)
+		return (NULL);
+	if (memcmp(((t_trace_head *)map)->magic, TRACE_MAGIC, 8)
+		|| TRACE_VERSION != ((t_trace_head *)map)->version)
+	{
+		fprintf(stderr, "%s: not a philo trace\n", path);
+		munmap(map, *len);
+		return (NULL);
+	}
+	if (!valid_layout(map, *len))
+	{
+		fprintf(stderr, "%s: truncated or damaged trace\n", path);
+		munmap(map, *len);
+		return (NULL);
+	}
+	return (map);
+}
+
+int	main(int ac, char **av)
+{
+	t_dump		d;
+	size_t		len;
+	const char	*mode;
+
+	mode = "--text";
+	if (3 == ac)
+		mode = av[1];
+	if (ac < 2 || ac > 3 || (strcmp(mode, "--text") && strcmp(mode,
+				"--text-us") && strcmp(mode, "--forks")
+			&& strcmp(mode, "--chrome")))
+	{
+		fprintf(stderr, "usage: %s [--text|--text-us|--forks|--chrome] file\n",
+			av[0]);
+		return (EXIT_FAILURE);
+	}
+	d.head = load(av[ac - 1], &len);
+	if (NULL == d.head)
+		return (EXIT_FAILURE);
+	collect(&d, (t_trace_seg *)(d.head + 1),
+		(t_trace_rec *)((t_trace_seg *)(d.head + 1) + d.head->seg_nbr));
+	if (!strncmp(mode, "--text", 6))
+		dump_text(&d, !strcmp(mode, "--text-us"));
+	else if (!strcmp(mode, "--forks"))
+		dump_forks(&d);
+	else
+		chrome(&d);
+	free(d.items);
+	munmap(d.head, len);
+	return (EXIT_SUCCESS);
+}
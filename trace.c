@@ -0,0 +1,186 @@
+#include "philo.h"
+#include <fcntl.h>
+
+/*
+ * BINARY TRACE, --trace=file
+ *
+ * Every event of write_status (and every fork release, the
+ * text log does not have it) becomes a 16 bytes record
+ * stored straight in a MAP_SHARED file mapping:
+ * 	~no formatting, no syscall, no lock: 2 stores + a counter
+ * 	~1 segment per log ring, so 1 writer per segment,
+ * 		exactly like the rings of logger.c
+ * 	~the DIED gets its own segment, the first death wins
+ * 		so it has 1 writer too
+ * 	~the pages belong to the kernel page cache: a crash
+ * 		of the process does not lose the trace
+ *
+ * A segment is a flight recorder, the oldest records are
+ * overwritten: the file size is bounded, the last minutes
+ * before a late death are always there.
+ *
+ * 💡 tools/philo_trace decodes it: text log, fork
+ * 	utilisation, Chrome trace-event JSON 💡
+*/
+
+/*
+ * Philos writing in the segment times TRACE_PHILO_RECORDS,
+ * power of 2 so the index is a mask
+*/
+static long	seg_capacity(t_table *table, long seg)
+{
+	long	philos;
+	long	cap;
+
+	if (seg == table->log.ring_nbr)
+		return (1);
+	philos = 1;
+	if (ENGINE_CORO == table->opt.engine)
+		philos = table->philo_nbr / table->opt.workers + 1;
+	else if (ENGINE_VIRTUAL == table->opt.engine)
+		philos = table->philo_nbr;
+	cap = TRACE_PHILO_RECORDS;
+	while (cap / TRACE_PHILO_RECORDS < philos && cap < TRACE_SEG_MAX)
+		cap *= 2;
+	return (cap);
+}
+
+static void	trace_layout(t_table *table, long seg_nbr)
+{
+	t_trace_head	*head;
+	long			i;
+	long			first;
+
+	head = table->trace.head;
+	memcpy(head->magic, TRACE_MAGIC, sizeof(head->magic));
+	head->version = TRACE_VERSION;
+	head->seg_nbr = seg_nbr;
+	head->philo_nbr = table->philo_nbr;
+	head->time_to_die = table->time_to_die;
+	head->time_to_eat = table->time_to_eat;
+	head->time_to_sleep = table->time_to_sleep;
+	first = 0;
+	i = -1;
+	while (++i < seg_nbr)
+	{
+		table->trace.segs[i].capacity = seg_capacity(table, i);
+		table->trace.segs[i].first = first;
+		first += table->trace.segs[i].capacity;
+	}
+}
+
+/*
+ * After log_init, the segments follow the rings.
+ * ftruncate makes a sparse file: only the pages
+ * really written take disk space
+*/
+void	trace_init(t_table *table)
+{
+	t_trace	*trace;
+	long	seg_nbr;
+	long	records;
+	long	i;
+
+	trace = &table->trace;
+	trace->map = NULL;
+	if (NULL == table->opt.trace)
+		return ;
+	seg_nbr = table->log.ring_nbr + 1;
+	records = 0;
+	i = -1;
+	while (++i < seg_nbr)
+		records += seg_capacity(table, i);
+	trace->len = sizeof(t_trace_head) + seg_nbr * sizeof(t_trace_seg)
+		+ records * sizeof(t_trace_rec);
+	trace->fd = open(table->opt.trace, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (trace->fd < 0 || ftruncate(trace->fd, trace->len))
+		error_exit("Cannot create the --trace file");
+	trace->map = mmap(NULL, trace->len, PROT_READ | PROT_WRITE, MAP_SHARED,
+			trace->fd, 0);
+	if (MAP_FAILED == trace->map)
+		error_exit("mmap of the --trace file failed");
+	trace->head = trace->map;
+	trace->segs = (t_trace_seg *)(trace->head + 1);
+	trace->recs = (t_trace_rec *)(trace->segs + seg_nbr);
+	trace_layout(table, seg_nbr);
+}
+
+/*
+ * start_simulation is known only at the gate
+*/
+void	trace_start(t_table *table)
+{
+	if (table->trace.map)
+		table->trace.head->start = table->start_simulation;
+}
+
+/*
+ * The hot path: only the owner of seg calls it.
+ * The death deadline of DIED does not fit in 24 bits, dropped
+*/
+void	trace_record(t_table *table, long seg, t_event *ev)
+{
+	t_trace_seg	*s;
+	t_trace_rec	*rec;
+	long		aux;
+
+	s = table->trace.segs + seg;
+	rec = table->trace.recs + s->first + (s->count & (s->capacity - 1));
+	aux = ev->aux;
+	if (DIED == ev->status)
+		aux = 0;
+	rec->time = ev->time;
+	rec->philo_id = ev->philo_id;
+	rec->kind = (uint32_t)ev->status | (uint32_t)aux << 8;
+	s->count++;
+}
+
+/*
+ * The segment of the ring the philo pushes to,
+ * the VIRTUAL engine has no rings: segment 0
+*/
+static long	seg_of(t_philo *philo)
+{
+	if (NULL == philo->ring)
+		return (0);
+	return (philo->ring - philo->table->log.rings);
+}
+
+void	trace_status(t_philo *philo, t_event *ev)
+{
+	t_table	*table;
+
+	table = philo->table;
+	if (NULL == table->trace.map)
+		return ;
+	if (DIED == ev->status)
+		trace_record(table, table->log.ring_nbr, ev);
+	else
+		trace_record(table, seg_of(philo), ev);
+}
+
+/*
+ * Both forks are back on the table
+*/
+void	trace_drops(t_philo *philo, long now)
+{
+	t_event	ev;
+
+	if (NULL == philo->table->trace.map)
+		return ;
+	ev.time = now;
+	ev.philo_id = philo->id;
+	ev.status = DROP_FORK;
+	ev.aux = philo->first_fork->fork_id;
+	trace_record(philo->table, seg_of(philo), &ev);
+	ev.aux = philo->second_fork->fork_id;
+	trace_record(philo->table, seg_of(philo), &ev);
+}
+
+void	trace_close(t_table *table)
+{
+	if (NULL == table->trace.map)
+		return ;
+	munmap(table->trace.map, table->trace.len);
+	close(table->trace.fd);
+}
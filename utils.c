@@ -1,77 +1,170 @@
 #include "philo.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/prctl.h>
 
 /*
- * Returns time in milliseconds, microseconds,
- * hence scientific notation here is top
+ * Returns time in seconds, milliseconds, microseconds
+ * or nanoseconds.
+ *
+ * 💡 CLOCK_MONOTONIC, not gettimeofday: it never jumps
+ * 	back or forward with NTP or the user changing the date.
+ * 	All integer math, no more 1e3 doubles 💡
  *
  * return just to trick -Werror...
  * cause my error_exit will already...exit 😂
 */
 long	gettime(int time_code)
 {
-	struct timeval	tv;
+	struct timespec	ts;
 
-	if (gettimeofday(&tv, NULL))
-		error_exit("Gettimeofday failed");
-	if (MILLISECOND == time_code)
-		return (tv.tv_sec * 1e3 + tv.tv_usec / 1e3);
+	if (clock_gettime(CLOCK_MONOTONIC, &ts))
+		error_exit("clock_gettime failed");
+	if (NANOSECOND == time_code)
+		return (ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec);
+	else if (MILLISECOND == time_code)
+		return (ts.tv_sec * 1000 + ts.tv_nsec / NSEC_PER_MSEC);
 	else if (MICROSECOND == time_code)
-		return (tv.tv_sec * 1e6 + tv.tv_usec);
+		return (ts.tv_sec * 1000000 + ts.tv_nsec / NSEC_PER_USEC);
 	else if (SECONDS == time_code)
-		return (tv.tv_sec + tv.tv_usec / 1e6);
+		return (ts.tv_sec);
 	else
 		error_exit("Wrong input to gettime:"
-			"use <MILLISECOND> <MICROSECOND> <SECONDS>");
+			"use <MILLISECOND> <MICROSECOND> <NANOSECOND> <SECONDS>");
 	return (1337);
 }
 
 /*
- * HYBRID approach
- * given usleep is not precise
- * i usleep for majority of time ,
- * then refine wiht busy wait
+ * Kernel sleep until an ABSOLUTE monotonic time,
+ * EINTR just means try again
 */
-void	precise_usleep(long usec, t_table *table)
+void	kernel_sleep_until(long deadline)
 {
-	long	start;
-	long	elapsed;
-	long	rem;
+	struct timespec	ts;
+
+	ts.tv_sec = deadline / NSEC_PER_SEC;
+	ts.tv_nsec = deadline % NSEC_PER_SEC;
+	while (EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL))
+		;
+}
 
-	start = gettime(MICROSECOND);
-	while (gettime(MICROSECOND) - start < usec)
+/*
+ * HYBRID approach, against ABSOLUTE deadlines (NANOSECOND)
+ * 1) kernel sleep until deadline - spin_ns, on the end_word
+ * 		futex: the end of the simulation cuts it short
+ * 2) busy wait only the last spin_ns, calibrated at start
+ *
+ * 💡 The caller passes the deadline, not a duration:
+ * 	time lost printing, waking up late or waiting for a fork
+ * 	is not added again at every phase, no drift 💡
+*/
+void	precise_sleep_until(long deadline, t_table *table)
+{
+	long	now;
+	long	wake;
+
+	while (!simulation_finished(table))
 	{
-		if (simulation_finished(table))
-			break ;
-		elapsed = gettime(MICROSECOND) - start;
-		rem = usec - elapsed;
-		if (rem > 1e4)
-			usleep(rem / 2);
+		now = gettime(NANOSECOND);
+		if (now >= deadline)
+			return ;
+		wake = deadline - table->spin_ns;
+		if (wake > now)
+			end_sleep_until(table, wake);
 		else
-			while (gettime(MICROSECOND) - start < usec)
+			while (gettime(NANOSECOND) < deadline)
 				;
 	}
 }
 
+/*
+ * --hires: the kernel pads every timed sleep of the
+ * thread with its timer slack, 50 us by default, to
+ * batch the wake ups. Fine for 200 ms meals, not for
+ * 500 us ones: 1 ns, the sleeps end on time.
+ * Per thread, every thread of the dinner calls it
+ * at the start gate
+*/
+void	hires_slack(t_table *table)
+{
+	if (table->opt.hires)
+		prctl(PR_SET_TIMERSLACK, 1UL, 0UL, 0UL, 0UL);
+}
+
+/*
+ * How late does the kernel wake us up?
+ * A few short absolute sleeps, the worst overshoot x2
+ * becomes the spin window of precise_sleep_until.
+ * Clamped, old code used to spin 10ms 🔥
+ *
+ * --hires measures with the 1 ns slack of the dinner
+ * threads, then gives the caller its own slack back
+ * (libphilo runs on the threads of somebody else)
+*/
+void	calibrate_spin(t_table *table)
+{
+	long	i;
+	long	target;
+	long	late;
+	long	worst;
+	int		slack;
+
+	slack = prctl(PR_GET_TIMERSLACK, 0UL, 0UL, 0UL, 0UL);
+	hires_slack(table);
+	worst = 0;
+	i = -1;
+	while (++i < CALIBRATION_ROUNDS)
+	{
+		target = gettime(NANOSECOND) + 200 * NSEC_PER_USEC;
+		kernel_sleep_until(target);
+		late = gettime(NANOSECOND) - target;
+		if (late > worst)
+			worst = late;
+	}
+	if (table->opt.hires && slack > 0)
+		prctl(PR_SET_TIMERSLACK, (unsigned long)slack, 0UL, 0UL, 0UL);
+	table->spin_ns = worst * 2;
+	if (table->opt.hires && table->spin_ns < HIRES_SPIN_MIN_NS)
+		table->spin_ns = HIRES_SPIN_MIN_NS;
+	else if (!table->opt.hires && table->spin_ns < SPIN_MIN_NS)
+		table->spin_ns = SPIN_MIN_NS;
+	else if (table->spin_ns > SPIN_MAX_NS)
+		table->spin_ns = SPIN_MAX_NS;
+}
+
 /*
  * Avoid memory leaks
 */
 void	clean(t_table *table)
 {
-	t_philo	*philo;
 	int		i;
 
 	i = -1;
-	while (++i < table->philo_nbr)
-	{
-		philo = table->philos + i;
-		safe_mutex_handle(&philo->philo_mutex, DESTROY);
-	}
-	safe_mutex_handle(&table->write_mutex, DESTROY);
-	safe_mutex_handle(&table->table_mutex, DESTROY);
+	while (++i < table->philo_nbr
+		&& !strcmp(table->opt.lock->name, "pthread"))
+		safe_mutex_handle(&table->forks[i].fork, DESTROY);
+	log_destroy(table);
+	trace_close(table);
+	replay_close(table);
+	shm_close(table);
+	if (table->opt.strategy->destroy)
+		table->opt.strategy->destroy(table);
+	safe_mutex_handle(&table->monitor_mutex, DESTROY);
+	safe_cond_handle(&table->monitor_cond, DESTROY);
+	gate_destroy(&table->start_gate);
+	if (ENGINE_CORO == table->opt.engine)
+		coro_destroy(table);
+	else if (ENGINE_VIRTUAL == table->opt.engine)
+		virtual_destroy(table);
+	else if (ENGINE_PROCESS == table->opt.engine)
+		process_destroy(table);
 	free(table->forks);
 	free(table->philos);
+	free(table->deadlines);
+	free(table->fairness);
+	free(table->fork_stats);
+	free(table->monitors);
+	free(table->aff.cpus);
 }
 
 /*
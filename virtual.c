@@ -0,0 +1,91 @@
+#include "philo.h"
+
+/*
+ * VIRTUAL engine, --virtual-time
+ *
+ * No threads, no clock: a discrete-event simulation.
+ * Every philo has at most 1 pending event in a min-heap
+ * of virtual timestamps, the loop pops the earliest and
+ * runs that philo until it has to wait again (virtual_steps.c).
+ *
+ * 💡 Time jumps from event to event, so 10 minutes of
+ * 	dinner cost only the events in between 💡
+ *
+ * Equal timestamps are ordered by a random tie drawn
+ * from a xorshift seeded with --seed:
+ * same seed -> same interleaving -> same output
+*/
+
+static unsigned long	next_rand(t_virtual *virt)
+{
+	virt->rng ^= virt->rng >> 12;
+	virt->rng ^= virt->rng << 25;
+	virt->rng ^= virt->rng >> 27;
+	return (virt->rng * 2685821657736338717UL);
+}
+
+void	virtual_schedule(t_table *table, long idx, long when, t_vstep step)
+{
+	table->virt.steps[idx] = step;
+	heap_push_tie(&table->virt.events, when, idx, next_rand(&table->virt));
+}
+
+/*
+ * Same lines of the threaded engines, written
+ * synchronously: events already come in time order.
+ * --quiet still traces everything and feeds --shm,
+ * the clock of its publish is read every 1024 events
+*/
+void	virtual_log(t_table *table, t_philo_status status, long idx)
+{
+	t_event	ev;
+
+	ev.time = table->virt.now;
+	ev.aux = status_aux(status, table->philos + idx);
+	if (DIED == status)
+		ev.aux = table->virt.now - 1;
+	ev.philo_id = table->philos[idx].id;
+	ev.status = status;
+	ev.debug = DEBUG_MODE;
+	trace_status(table->philos + idx, &ev);
+	if (0 == (table->virt.handled & 1023))
+		shm_publish(table, false);
+	if (table->opt.quiet && DIED != status)
+		shm_event(table, &ev);
+	else
+		log_emit(table, &ev);
+}
+
+void	virtual_init(t_table *table)
+{
+	t_virtual	*virt;
+	long		i;
+
+	virt = &table->virt;
+	virt->events.nodes = safe_malloc(table->philo_nbr * sizeof(t_deadline));
+	virt->events.size = 0;
+	virt->deaths.nodes = safe_malloc(table->philo_nbr * sizeof(t_deadline));
+	virt->deaths.size = 0;
+	virt->steps = safe_malloc(table->philo_nbr * sizeof(t_vstep));
+	virt->owner = safe_malloc(table->philo_nbr * sizeof(long));
+	virt->waiter = safe_malloc(table->philo_nbr * sizeof(long));
+	virt->now = 0;
+	virt->rng = table->opt.seed ^ 0x9E3779B97F4A7C15UL;
+	virt->handled = 0;
+	virt->dead = -1;
+	i = -1;
+	while (++i < table->philo_nbr)
+	{
+		virt->owner[i] = -1;
+		virt->waiter[i] = -1;
+	}
+}
+
+void	virtual_destroy(t_table *table)
+{
+	free(table->virt.events.nodes);
+	free(table->virt.deaths.nodes);
+	free(table->virt.steps);
+	free(table->virt.owner);
+	free(table->virt.waiter);
+}
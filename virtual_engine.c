@@ -0,0 +1,127 @@
+#include "philo.h"
+
+/*
+ * VIRTUAL engine, the event loop
+ *
+ * Before running the next event the loop asks the
+ * deadline heap (the monitor one, same lazy re-keying)
+ * if somebody starves first: death at
+ * last_meal + t_die + 1ns, exact, no monitor latency.
+ *
+ * Stops on:
+ * 	~a death, DIED is the last line as usual
+ * 	~no events left, everybody is full
+ * 	~--duration reached, the config survived
+*/
+
+/*
+ * Earliest death of a hungry philo, LONG_MAX if none
+*/
+static long	next_death(t_table *table)
+{
+	t_heap	*heap;
+	long	when;
+
+	heap = &table->virt.deaths;
+	while (heap->size)
+	{
+		when = get_long(table->deadlines + heap->nodes[0].philo_idx);
+		if (LONG_MAX == when)
+		{
+			heap_pop(heap);
+			continue ;
+		}
+		when += 1;
+		if (when == heap->nodes[0].when)
+			return (when);
+		heap_update_top(heap, when);
+	}
+	return (LONG_MAX);
+}
+
+static void	event_loop(t_table *table)
+{
+	t_virtual	*virt;
+	long		next;
+	long		death;
+	long		idx;
+
+	virt = &table->virt;
+	while (1)
+	{
+		next = LONG_MAX;
+		if (virt->events.size)
+			next = virt->events.nodes[0].when;
+		death = next_death(table);
+		if (LONG_MAX != death && death <= next
+			&& death <= table->opt.duration)
+		{
+			virt->now = death;
+			virt->dead = virt->deaths.nodes[0].philo_idx;
+			return ;
+		}
+		if (0 == virt->events.size || next > table->opt.duration)
+			return ;
+		virt->now = next;
+		idx = virt->events.nodes[0].philo_idx;
+		heap_pop(&virt->events);
+		virt->handled++;
+		virtual_step(table, idx);
+	}
+}
+
+/*
+ * One line on stderr, stdout keeps the classic output
+*/
+static void	summary(t_table *table, long wall)
+{
+	t_virtual	*virt;
+
+	virt = &table->virt;
+	if (-1 != virt->dead)
+		fprintf(stderr, "[virtual] seed %lu: %d died at %ld ms",
+			table->opt.seed, table->philos[virt->dead].id,
+			virt->now / NSEC_PER_MSEC);
+	else if (virt->events.size)
+		fprintf(stderr, "[virtual] seed %lu: survived %ld ms",
+			table->opt.seed, table->opt.duration / NSEC_PER_MSEC);
+	else
+		fprintf(stderr, "[virtual] seed %lu: all full at %ld ms",
+			table->opt.seed, virt->now / NSEC_PER_MSEC);
+	fprintf(stderr, ", %ld events in %ld ms\n", virt->handled,
+		wall / NSEC_PER_MSEC);
+}
+
+/*
+ * Same start of the threaded engines:
+ * everybody ate at 0, then de_synchronize offsets.
+ * The lone philo takes its fork and waits for death
+*/
+void	virtual_dinner_start(t_table *table)
+{
+	long	i;
+	long	wall;
+
+	wall = gettime(NANOSECOND);
+	table->start_simulation = 0;
+	trace_start(table);
+	i = -1;
+	while (++i < table->philo_nbr)
+	{
+		heap_push(&table->virt.deaths, table->time_to_die + 1, i);
+		if (METRICS)
+			fairness_want(table->philos + i, desync_offset(table->philos + i));
+		if (1 == table->philo_nbr)
+			virtual_log(table, TAKE_FIRST_FORK, i);
+		else
+			virtual_schedule(table, i, desync_offset(table->philos + i),
+				V_TAKE_FIRST);
+	}
+	event_loop(table);
+	set_bool(&table->end_simulation, true);
+	if (-1 != table->virt.dead)
+		virtual_log(table, DIED, table->virt.dead);
+	log_flush(&table->log);
+	if (table->log.fd >= 0)
+		summary(table, gettime(NANOSECOND) - wall);
+}
@@ -0,0 +1,126 @@
+#include "philo.h"
+
+/*
+ * VIRTUAL engine, the philo state machine
+ *
+ * Same dinner of dinner.c, cut where a thread would block:
+ * 	V_TAKE_FIRST	-> first fork, then straight to the second
+ * 	V_TAKE_SECOND	-> second fork, eat until last_meal + t_eat
+ * 	V_DROP_FORKS	-> maybe full, release, sleep until
+ * 						last_meal + t_eat + t_sleep
+ * 	V_THINK		-> think_until, then V_TAKE_FIRST
+ *
+ * A busy fork parks the philo as waiter, no event:
+ * the owner hands it over on release, like the CORO engine
+*/
+
+/*
+ * Free, or already handed to me by the last owner
+*/
+static bool	grab(t_virtual *virt, long idx, t_fork *fork)
+{
+	long	owner;
+
+	owner = virt->owner[fork->fork_id];
+	if (-1 == owner || idx == owner)
+	{
+		virt->owner[fork->fork_id] = idx;
+		return (true);
+	}
+	virt->waiter[fork->fork_id] = idx;
+	return (false);
+}
+
+/*
+ * The waiter resumes at the same virtual time,
+ * as a new event: the seed decides who goes first
+*/
+static void	release(t_table *table, t_fork *fork)
+{
+	t_virtual	*virt;
+	long		waiter;
+
+	virt = &table->virt;
+	waiter = virt->waiter[fork->fork_id];
+	virt->waiter[fork->fork_id] = -1;
+	virt->owner[fork->fork_id] = waiter;
+	if (-1 != waiter)
+		virtual_schedule(table, waiter, virt->now, virt->steps[waiter]);
+}
+
+static void	take_forks(t_table *table, long idx)
+{
+	t_philo		*philo;
+	t_virtual	*virt;
+
+	philo = table->philos + idx;
+	virt = &table->virt;
+	if (V_TAKE_FIRST == virt->steps[idx])
+	{
+		if (!grab(virt, idx, philo->first_fork))
+			return ;
+		virtual_log(table, TAKE_FIRST_FORK, idx);
+		virt->steps[idx] = V_TAKE_SECOND;
+	}
+	if (!grab(virt, idx, philo->second_fork))
+		return ;
+	virtual_log(table, TAKE_SECOND_FORK, idx);
+	if (METRICS)
+		fairness_meal(philo, virt->now);
+	if (THINK_ADAPTIVE == table->opt.think)
+		adaptive_feedback(philo, virt->now);
+	publish_meal(philo, virt->now);
+	increase_long(&philo->meals_counter);
+	virtual_log(table, EATING, idx);
+	virtual_schedule(table, idx, virt->now + table->time_to_eat,
+		V_DROP_FORKS);
+}
+
+static void	done_eating(t_table *table, long idx)
+{
+	t_philo	*philo;
+
+	philo = table->philos + idx;
+	if (table->nbr_limit_meals > 0
+		&& get_long(&philo->meals_counter) == table->nbr_limit_meals)
+		publish_full(philo);
+	release(table, philo->first_fork);
+	release(table, philo->second_fork);
+	trace_drops(philo, table->virt.now);
+	if (get_bool(&philo->full))
+		return ;
+	virtual_log(table, SLEEPING, idx);
+	virtual_schedule(table, idx, get_long(&philo->last_meal_time)
+		+ table->time_to_eat + table->time_to_sleep, V_THINK);
+}
+
+/*
+ * Run the philo from its current step until
+ * it has to wait for the clock or for a fork
+*/
+void	virtual_step(t_table *table, long idx)
+{
+	t_virtual	*virt;
+	long		end;
+
+	virt = &table->virt;
+	if (V_DROP_FORKS == virt->steps[idx])
+	{
+		done_eating(table, idx);
+		return ;
+	}
+	if (V_THINK == virt->steps[idx])
+	{
+		virtual_log(table, THINKING, idx);
+		end = think_until(table->philos + idx, virt->now);
+		if (METRICS)
+			fairness_want(table->philos + idx, end);
+		if (end > virt->now)
+		{
+			virtual_schedule(table, idx, end, V_TAKE_FIRST);
+			return ;
+		}
+		virt->steps[idx] = V_TAKE_FIRST;
+	}
+	take_forks(table, idx);
+}
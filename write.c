@@ -1,62 +1,86 @@
 #include "philo.h"
-#include <time.h>
 
 /*
- * The same as write, just with more info
- * helping when debugging
+ * Extra info only the debug output needs:
+ * 	~the fork id for the fork lines
+ * 	~the meals counter for the eating line
+ * The died line carries the deadline the monitor checked,
+ * see write_death
 */
-static void	write_status_debug(t_philo_status status, t_philo *philo,
-		long elapsed)
+long	status_aux(t_philo_status status, t_philo *philo)
 {
-	if (TAKE_FIRST_FORK == status && !simulation_finished(philo->table))
-		printf(W"%6ld"RST" %d has taken the 1° fork 🍽"
-			"\t\t\tn°"B"[🍴 %d 🍴]\n"RST, elapsed, philo->id,
-			philo->first_fork->fork_id);
-	else if (TAKE_SECOND_FORK == status && !simulation_finished(philo->table))
-		printf(W"%6ld"RST" %d has taken the 2° fork 🍽"
-			"\t\t\tn°"B"[🍴 %d 🍴]\n"RST, elapsed, philo->id,
-			philo->second_fork->fork_id);
-	else if (EATING == status && !simulation_finished(philo->table))
-		printf(W"%6ld"C" %d is eating 🍝"
-			"\t\t\t"Y"[🍝 %ld 🍝]\n"RST, elapsed, philo->id, philo->meals_counter);
-	else if (SLEEPING == status && !simulation_finished(philo->table))
-		printf(W"%6ld"RST" %d is sleeping 😴\n", elapsed, philo->id);
-	else if (THINKING == status && !simulation_finished(philo->table))
-		printf(W"%6ld"RST" %d is thinking 🤔\n", elapsed, philo->id);
-	else if (DIED == status)
-		printf(RED"\t\t💀💀💀 %6ld %d died   💀💀💀\n"RST, elapsed, philo->id);
+	if (TAKE_FIRST_FORK == status)
+		return (philo->first_fork->fork_id);
+	else if (TAKE_SECOND_FORK == status)
+		return (philo->second_fork->fork_id);
+	else if (EATING == status)
+		return (get_long(&philo->meals_counter));
+	return (0);
+}
+
+static void	post_event(t_philo *philo, t_event *ev)
+{
+	trace_status(philo, ev);
+	if (DIED == ev->status)
+		log_post_death(philo->table, ev);
+	else
+		log_push(philo->ring, ev, philo->table);
 }
 
 /*
  * Function to write the philo status
  * in a thread safe manner
- * 🔒 write
- * 🔒 philo's mutex to read meals counter
- * 🔒 table's lock to read if end_simulation
+ *
+ * 💡 No printf here anymore: the philo just pushes a
+ * 	fixed size event in its own ring and goes back to
+ * 	the dinner. The writer thread (logger.c) merges all
+ * 	the rings in timestamp order and writes in batches 💡
+ *
+ * 🔓 atomic read of full
+ * 🔓 atomic read of end_simulation, after the death
+ * 		only the DIED event is accepted (write_death)
+ *
+ * 🚨 The old write_mutex printed every status that passed
+ * 	the check: the ring is busy from BEFORE the check until
+ * 	the push, the writer waits for it before its last drain.
+ * 	busy store, end load, the claim and the writer load are
+ * 	all seq_cst: the writer sees busy, or this check sees
+ * 	the end 🚨
+ *
+ * --trace: the same event also goes in the binary trace
 */
 void	write_status(t_philo_status status, t_philo *philo, bool debug)
 {
-	long	elapsed;
+	t_event	ev;
 
-	elapsed = gettime(MILLISECOND) - philo->table->start_simulation;
-	if (get_bool(&philo->philo_mutex, &philo->full))
-		return ;
-	safe_mutex_handle(&philo->table->write_mutex, LOCK);
-	if (debug)
-		write_status_debug(status, philo, elapsed);
-	else
+	atomic_store(&philo->ring->busy, 1);
+	ev.time = gettime(NANOSECOND);
+	if (!get_bool(&philo->full) && !atomic_load(&philo->table->end_simulation))
 	{
-		if ((TAKE_FIRST_FORK == status || TAKE_SECOND_FORK == status)
-			&& !simulation_finished(philo->table))
-			printf(W"%-6ld"RST" %d has taken a fork\n", elapsed, philo->id);
-		else if (EATING == status && !simulation_finished(philo->table))
-			printf(W"%-6ld"C" %d is eating\n"RST, elapsed, philo->id);
-		else if (SLEEPING == status && !simulation_finished(philo->table))
-			printf(W"%-6ld"RST" %d is sleeping\n", elapsed, philo->id);
-		else if (THINKING == status && !simulation_finished(philo->table))
-			printf(W"%-6ld"RST" %d is thinking\n", elapsed, philo->id);
-		else if (DIED == status)
-			printf(RED"%-6ld %d died\n"RST, elapsed, philo->id);
+		ev.aux = status_aux(status, philo);
+		ev.philo_id = philo->id;
+		ev.status = status;
+		ev.debug = debug;
+		post_event(philo, &ev);
 	}
-	safe_mutex_handle(&philo->table->write_mutex, UNLOCK);
+	atomic_store_explicit(&philo->ring->busy, 0, memory_order_release);
+}
+
+/*
+ * The monitor that won claim_death, with the deadline
+ * it found passed: read again now it could already be the
+ * one of a meal after the end, or LONG_MAX (METRICS latency)
+*/
+void	write_death(t_philo *philo, long deadline)
+{
+	t_event	ev;
+
+	ev.time = gettime(NANOSECOND);
+	if (get_bool(&philo->full))
+		return ;
+	ev.aux = deadline;
+	ev.philo_id = philo->id;
+	ev.status = DIED;
+	ev.debug = DEBUG_MODE;
+	post_event(philo, &ev);
 }